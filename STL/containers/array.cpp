@@ -2,16 +2,59 @@
 
 // Input/Output
 #include <iostream>
+#include <cstdio>
 // Diagnostics
 #include <exception>
+#include <cerrno>
 // General Utilities
 #include <type_traits>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <tuple>
+// Memory
+#include <memory>
+#include <new>
+// Files (open, mmap, writev)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+// Strings
+#include <cstring>
+#include <string>
+// Benchmark baselines
+#include <array>
 // Concurrency
 #include <thread>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+// Time
+#include <chrono>
+// SIMD intrinsics
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // Usage:
 // g++ array.cpp -o test -lpthread
+// Swap/fill/copy of Array<float, 4096>, SIMD against element loops,
+// then Array against std::array, a table or JSON:
+// g++ -O2 array.cpp -o test -lpthread && ./test --bench
+// ./test --bench --json > bench.json
+// Scalar comparisons only, no SSE2/AVX2 kernels:
+// g++ -DLIB_SIMD=0 array.cpp -o test -lpthread
+// Parallel algorithms on 3 threads, the caller and 2 pool workers:
+// LIB_THREADS=3 ./test
 
 // MISRA C++ 
 // Rule 7–3–1
@@ -23,6 +66,16 @@
 // Macros shall only be #define’d or #undef’d in the global namespace.
 
 #define _IsUnused  __attribute__ ((__unused__))
+// SSE2/AVX2 comparison kernels, selected at run time
+#ifndef LIB_SIMD
+#define LIB_SIMD 1
+#endif
+#define _Target_sse2 __attribute__ ((__target__ ("sse2")))
+#define _Target_avx2 __attribute__ ((__target__ ("avx2")))
+#define _Target_sse42 __attribute__ ((__target__ ("sse4.2")))
+// Keeps the replaced operator new/delete out of their callers, so GCC
+// does not pair a new-expression with the std::free inside delete
+#define _Noinline __attribute__ ((__noinline__))
 
 // Type checking
 namespace
@@ -34,6 +87,8 @@ type
 	struct forward_iterator_tag : public input_iterator_tag { };
 	struct bidirectional_iterator_tag : public forward_iterator_tag { };
 	struct random_access_iterator_tag : public bidirectional_iterator_tag { };
+	// Elements at consecutive addresses: &*(it + n) == &*it + n
+	struct contiguous_iterator_tag : public random_access_iterator_tag { };
 		
 	template <typename Iterator>
 	struct 
@@ -49,7 +104,7 @@ type
 	struct 
 	Iterator_traits<T*>	
 	{
-		typedef random_access_iterator_tag					 iterator_category;
+		typedef contiguous_iterator_tag							 iterator_category;
 		typedef T															       value_type;
 		typedef std::ptrdiff_t										   difference_type;
 		typedef T*												           pointer;
@@ -59,7 +114,7 @@ type
 	struct 
 	Iterator_traits<const T*>	
 	{
-		typedef random_access_iterator_tag					 iterator_category;
+		typedef contiguous_iterator_tag							 iterator_category;
 		typedef T															       value_type;
 		typedef std::ptrdiff_t										   difference_type;
 		typedef const T*									           pointer;
@@ -322,6 +377,21 @@ type
 		T __j;
 		typename type::Iterator_traits<T>::difference_type __n;
 	}; 
+	template <class T>
+	struct 
+	ContiguousIteratorConcept
+	{
+		void __constraints() 
+		{
+			__function_requires< RandomAccessIteratorConcept<T> >();
+			__function_requires< ConvertibleConcept<
+																			        typename type::Iterator_traits<T>::iterator_category,
+																			        type::contiguous_iterator_tag> >();
+			// requires the element address as a pointer
+			typename type::Iterator_traits<T>::pointer __p _IsUnused = std::addressof(*__i);
+		}
+		T __i;
+	}; 
 	// Container Concepts
 	template <class _Container>
 	struct 
@@ -447,12 +517,413 @@ lib_impl
 	{
 		return (arr+n);
 	}	
+	//---
+	// SIMD kernels
+	// mismatch: index of the first element where a and b differ, n when all equal.
+	// Integers are compared as bytes, the first differing byte lies in the
+	// first differing element. float and double lanes compare with ==,
+	// so -0.0 equals 0.0 and NaN equals nothing, like the scalar loop.
+	// SSE2 is always there on x86-64, AVX2 is used when the CPU has it,
+	// the kernels are chosen once at run time.
+	// swap and fill work on bytes, fill repeats a 16 byte pattern.
+	class
+	Simd
+	{
+		public:
+			static
+			std::size_t
+			mismatch(const unsigned char* a, 
+								const unsigned char* b, 
+								std::size_t n)
+			{
+				return M_kernels().bytes(a, b, n);
+			}
+			static
+			std::size_t
+			mismatch(const float* a, 
+								const float* b, 
+								std::size_t n)
+			{
+				return M_kernels().floats(a, b, n);
+			}
+			static
+			std::size_t
+			mismatch(const double* a, 
+								const double* b, 
+								std::size_t n)
+			{
+				return M_kernels().doubles(a, b, n);
+			}
+			// Exchanges n bytes of a and b
+			static
+			void
+			swap(unsigned char* a, 
+						unsigned char* b, 
+						std::size_t n)
+			{
+				M_kernels().swap(a, b, n);
+			}
+			// Writes n bytes, repeating the 16 bytes of pattern
+			static
+			void
+			fill(unsigned char* dst, 
+						std::size_t n, 
+						const unsigned char* pattern)
+			{
+				M_kernels().fill(dst, n, pattern);
+			}
+			// Name of the instruction set in use
+			static
+			const char*
+			isa()
+			{
+				return M_kernels().name;
+			}
+		private:
+			struct
+			Kernels
+			{
+				std::size_t (*bytes)(const unsigned char*, const unsigned char*, std::size_t);
+				std::size_t (*floats)(const float*, const float*, std::size_t);
+				std::size_t (*doubles)(const double*, const double*, std::size_t);
+				void (*swap)(unsigned char*, unsigned char*, std::size_t);
+				void (*fill)(unsigned char*, std::size_t, const unsigned char*);
+				const char* name;
+			};
+			static
+			const Kernels&
+			M_kernels()
+			{
+				static const Kernels kernels = M_select();
+				return kernels;
+			}
+			static
+			Kernels
+			M_select()
+			{
+#if LIB_SIMD && (defined(__x86_64__) || defined(__i386__))
+				if (__builtin_cpu_supports("avx2"))
+				{
+					return Kernels{&M_bytes_avx2, &M_floats_avx2, &M_doubles_avx2, 
+													&M_swap_avx2, &M_fill_avx2, "avx2"};
+				}
+				if (__builtin_cpu_supports("sse2"))
+				{
+					return Kernels{&M_bytes_sse2, &M_floats_sse2, &M_doubles_sse2, 
+													&M_swap_sse2, &M_fill_sse2, "sse2"};
+				}
+#endif
+				return Kernels{&M_scalar<unsigned char>, &M_scalar<float>, &M_scalar<double>, 
+												&M_swap_scalar, &M_fill_scalar, "scalar"};
+			}
+			static
+			void
+			M_swap_scalar(unsigned char* a, 
+											unsigned char* b, 
+											std::size_t n)
+			{
+				for (std::size_t i = 0; i != n; ++i)
+				{
+					const unsigned char tmp = a[i];
+					a[i] = b[i];
+					b[i] = tmp;
+				}
+			}
+			static
+			void
+			M_fill_scalar(unsigned char* dst, 
+											std::size_t n, 
+											const unsigned char* pattern)
+			{
+				for (std::size_t i = 0; i != n; ++i)
+				{
+					dst[i] = pattern[i % 16];
+				}
+			}
+			template <typename T>
+			static
+			std::size_t
+			M_scalar(const T* a, 
+								const T* b, 
+								std::size_t n)
+			{
+				std::size_t i = 0;
+				while (i != n && a[i] == b[i])
+				{
+					++i;
+				}
+				return i;
+			}
+#if LIB_SIMD && (defined(__x86_64__) || defined(__i386__))
+			_Target_sse2
+			static
+			std::size_t
+			M_bytes_sse2(const unsigned char* a, 
+										const unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+					const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+					const unsigned mask = ~unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xFFFFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_bytes_avx2(const unsigned char* a, 
+										const unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 32 <= n; i += 32)
+				{
+					const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+					const unsigned mask = ~unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_bytes_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			std::size_t
+			M_floats_sse2(const float* a, 
+											const float* b, 
+											std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const unsigned mask = ~unsigned(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), 
+																																				_mm_loadu_ps(b + i)))) & 0xFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_floats_avx2(const float* a, 
+											const float* b, 
+											std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const unsigned mask = ~unsigned(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), 
+																																						_mm256_loadu_ps(b + i),
+																																						_CMP_EQ_OQ))) & 0xFFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_floats_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			std::size_t
+			M_doubles_sse2(const double* a, 
+												const double* b, 
+												std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+				{
+					const unsigned mask = ~unsigned(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), 
+																																				_mm_loadu_pd(b + i)))) & 0x3u;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_doubles_avx2(const double* a, 
+												const double* b, 
+												std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const unsigned mask = ~unsigned(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), 
+																																						_mm256_loadu_pd(b + i),
+																																						_CMP_EQ_OQ))) & 0xFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_doubles_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			void
+			M_swap_sse2(unsigned char* a, 
+										unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+					const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), y);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(b + i), x);
+				}
+				M_swap_scalar(a + i, b + i, n - i);
+			}
+			// Two registers per step keep both load ports busy
+			_Target_avx2
+			static
+			void
+			M_swap_avx2(unsigned char* a, 
+										unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 64 <= n; i += 64)
+				{
+					const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+					const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+					const __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), y0);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i + 32), y1);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i), x0);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i + 32), x1);
+				}
+				M_swap_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			void
+			M_fill_sse2(unsigned char* dst, 
+										std::size_t n, 
+										const unsigned char* pattern)
+			{
+				const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), p);
+				}
+				M_fill_scalar(dst + i, n - i, pattern);
+			}
+			_Target_avx2
+			static
+			void
+			M_fill_avx2(unsigned char* dst, 
+										std::size_t n, 
+										const unsigned char* pattern)
+			{
+				const __m256i p = _mm256_broadcastsi128_si256(
+														_mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern)));
+				std::size_t i = 0;
+				for (; i + 32 <= n; i += 32)
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), p);
+				}
+				M_fill_sse2(dst + i, n - i, pattern);
+			}
+#endif
+	};
+	//---
+	// Trivial kernels
+	// Ranges of trivially copyable elements behind raw pointers are
+	// copied with memcpy and filled with memset.
+	
+	// Elements of InputIt can be copied as bytes to OutputIt
+	template<typename InputIt, 
+						typename OutputIt>
+	struct
+	Use_memmove
+		: public type::false_type
+	{
+	};
+	template<typename T, 
+						typename U>
+	struct
+	Use_memmove<T*, U*>
+		: public type::__bool_constant<std::is_same<typename std::remove_const<T>::type, U>::value
+																		&& std::is_trivially_copyable<U>::value>
+	{
+	};
+	// Elements of OutputIt can be set with memset or the SIMD fill,
+	// sizes dividing 16 tile a 16 byte pattern
+	template<typename OutputIt>
+	struct
+	Use_memset
+		: public type::false_type
+	{
+	};
+	template<typename T>
+	struct
+	Use_memset<T*>
+		: public type::__bool_constant<std::is_trivially_copyable<T>::value
+																		&& !std::is_const<T>::value
+																		&& 16 % sizeof(T) == 0>
+	{
+	};
+	// The byte repeated by all bytes of val, if there is one
+	template<typename T>
+	inline
+	bool
+	memset_byte(const T& val, 
+								unsigned char& byte)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, std::addressof(val), sizeof(T));
+		byte = bytes[0];
+		for (std::size_t i = 1; i != sizeof(T); ++i)
+		{
+			if (bytes[i] != byte)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
 	template<class InputIt, 
 					class NoThrowForwardIt>
 	NoThrowForwardIt 
 	uninitialized_copy(InputIt first, 
 										InputIt last, 
-										NoThrowForwardIt d_first)
+										NoThrowForwardIt d_first,
+										type::true_type)
+	noexcept(false)
+	{
+		const std::ptrdiff_t n = last - first;
+		if (n > 0)
+		{
+			std::memcpy(d_first, first, std::size_t(n) * sizeof(*d_first));
+		}
+		return d_first + n;
+	}
+	template<class InputIt, 
+					class NoThrowForwardIt>
+	NoThrowForwardIt 
+	uninitialized_copy(InputIt first, 
+										InputIt last, 
+										NoThrowForwardIt d_first,
+										type::false_type)
 	noexcept(false)
 	{
 	  using T = typename type::Iterator_traits<NoThrowForwardIt>::value_type;
@@ -476,18 +947,206 @@ lib_impl
       throw;
 	  }
 	}
+	template<class InputIt, 
+					class NoThrowForwardIt>
+	NoThrowForwardIt 
+	uninitialized_copy(InputIt first, 
+										InputIt last, 
+										NoThrowForwardIt d_first)
+	noexcept(false)
+	{
+		return lib_impl::uninitialized_copy(first, last, d_first, 
+																				Use_memmove<InputIt, NoThrowForwardIt>());
+	}
 	template<typename OutputIt, 
 						typename Size, 
 						typename T>		
 	OutputIt 
 	fill_n(OutputIt result, 
 					Size count, 
-					const T& val)
+					const T& val,
+					type::false_type)
 	{
 		for (Size i = 0; i < count; i++)
 			*result++ = val;
 		return result;
 	}
+	template<typename OutputIt, 
+						typename Size, 
+						typename T>		
+	OutputIt 
+	fill_n(OutputIt result, 
+					Size count, 
+					const T& val,
+					type::true_type)
+	{
+		typedef typename type::Iterator_traits<OutputIt>::value_type
+		ValueType;
+		if (count <= 0)
+		{
+			return result;
+		}
+		const ValueType v = val;
+		const std::size_t bytes = std::size_t(count) * sizeof(ValueType);
+		unsigned char byte;
+		if (memset_byte(v, byte))
+		{
+			std::memset(result, byte, bytes);
+		}
+		else
+		{
+			unsigned char pattern[16];
+			for (std::size_t i = 0; i != 16; i += sizeof(ValueType))
+			{
+				std::memcpy(pattern + i, std::addressof(v), sizeof(ValueType));
+			}
+			Simd::fill(reinterpret_cast<unsigned char*>(result), bytes, pattern);
+		}
+		return result + count;
+	}
+	template<typename OutputIt, 
+						typename Size, 
+						typename T>		
+	OutputIt 
+	fill_n(OutputIt result, 
+					Size count, 
+					const T& val)
+	{
+		return lib_impl::fill_n(result, count, val, Use_memset<OutputIt>());
+	}
+	// Index of the first mismatch of [a, a + n) and [b, b + n)
+	template <typename T>
+	inline
+	std::size_t
+	simd_mismatch(const T* a, 
+									const T* b, 
+									std::size_t n)
+	{
+		// integers compare equal exactly when their bytes do
+		return Simd::mismatch(reinterpret_cast<const unsigned char*>(a), 
+													reinterpret_cast<const unsigned char*>(b), 
+													n * sizeof(T)) / sizeof(T);
+	}
+	inline
+	std::size_t
+	simd_mismatch(const float* a, 
+									const float* b, 
+									std::size_t n)
+	{
+		return Simd::mismatch(a, b, n);
+	}
+	inline
+	std::size_t
+	simd_mismatch(const double* a, 
+									const double* b, 
+									std::size_t n)
+	{
+		return Simd::mismatch(a, b, n);
+	}
+	// Element types the SIMD kernels compare
+	template <typename Iterator>
+	struct
+	Use_simd_compare
+		: public type::false_type
+	{
+	};
+	template <typename T>
+	struct
+	Use_simd_compare<T*>
+		: public type::__bool_constant<std::is_integral<typename std::remove_const<T>::type>::value
+																		|| std::is_same<typename std::remove_const<T>::type, float>::value
+																		|| std::is_same<typename std::remove_const<T>::type, double>::value>
+	{
+	};
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	equal(Iter1 first1, 
+				Iter1 last1, 
+				Iter2 first2, 
+				type::false_type)
+	{
+		return std::equal(first1, last1, first2);
+	}
+	template <typename T>
+	inline
+	bool
+	equal(const T* first1, 
+				const T* last1, 
+				const T* first2, 
+				type::true_type)
+	{
+		const std::size_t n = last1 - first1;
+		return (simd_mismatch(first1, first2, n) == n);
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	lexicographical_compare(Iter1 first1, 
+													Iter1 last1, 
+													Iter2 first2, 
+													Iter2 last2,
+													type::false_type)
+	{
+		return std::lexicographical_compare(first1, last1, first2, last2);
+	}
+	// Skips to each mismatch, elements neither less nor greater (NaN) 
+	// are passed over like in the scalar loop
+	template <typename T>
+	inline
+	bool
+	lexicographical_compare(const T* first1, 
+													const T* last1, 
+													const T* first2, 
+													const T* last2,
+													type::true_type)
+	{
+		const std::size_t n1 = last1 - first1;
+		const std::size_t n2 = last2 - first2;
+		const std::size_t n = (n1 < n2 ? n1 : n2);
+		std::size_t i = simd_mismatch(first1, first2, n);
+		while (i != n)
+		{
+			if (first1[i] < first2[i])
+			{
+				return true;
+			}
+			if (first2[i] < first1[i])
+			{
+				return false;
+			}
+			++i;
+			i += simd_mismatch(first1 + i, first2 + i, n - i);
+		}
+		return (n1 < n2);
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	equal(Iter1 first1, 
+				Iter1 last1, 
+				Iter2 first2)
+	{
+		return lib_impl::equal(first1, last1, first2,
+														type::__bool_constant<bool(Use_simd_compare<Iter1>{})
+																									&& std::is_same<Iter1, Iter2>::value>());
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	lexicographical_compare(Iter1 first1, 
+													Iter1 last1, 
+													Iter2 first2, 
+													Iter2 last2)
+	{
+		return lib_impl::lexicographical_compare(first1, last1, first2, last2,
+																							type::__bool_constant<bool(Use_simd_compare<Iter1>{})
+																																		&& std::is_same<Iter1, Iter2>::value>());
+	}
 	// Iterator swap
 	template <bool BType>
 	struct
@@ -537,9 +1196,9 @@ lib_impl
 		typedef typename type::Iterator_traits<Iter2>::reference
 		ReferenceType2;
 		
-		iter_s <type::is_same<ValueType1, ValueType2>::value
-							&& type::is_same<ValueType1&, ReferenceType1>::value
-							&& type::is_same<ValueType2&, ReferenceType2>::value>::
+		iter_s <bool(type::is_same<ValueType1, ValueType2>{})
+							&& bool(type::is_same<ValueType1&, ReferenceType1>{})
+							&& bool(type::is_same<ValueType2&, ReferenceType2>{})>::
 		swap(a, b);
 	}
 	template <typename Iter1,
@@ -547,69 +1206,1073 @@ lib_impl
 	Iter2
 	swap_ranges(Iter1 first1, 
 								Iter1 last1,
-	 							Iter2 first2)
+	 							Iter2 first2,
+	 							type::false_type)
 	{ 
 		for (; first1 != last1; ++first1, ++first2)
 		{
 			lib_impl::iter_swap(first1, first2);
 		}
 		return first2;
+	}
+	// Trivially copyable elements are exchanged as bytes
+	template <typename Iter1,
+							typename Iter2>
+	Iter2
+	swap_ranges(Iter1 first1, 
+								Iter1 last1,
+	 							Iter2 first2,
+	 							type::true_type)
+	{ 
+		const std::ptrdiff_t n = last1 - first1;
+		if (n > 0)
+		{
+			Simd::swap(reinterpret_cast<unsigned char*>(first1), 
+									reinterpret_cast<unsigned char*>(first2), 
+									std::size_t(n) * sizeof(*first1));
+		}
+		return first2 + n;
+	}
+	template <typename Iter1,
+							typename Iter2>
+	Iter2
+	swap_ranges(Iter1 first1, 
+								Iter1 last1,
+	 							Iter2 first2)
+	{ 
+		return lib_impl::swap_ranges(first1, last1, first2, 
+																	type::__bool_constant<bool(Use_memmove<Iter1, Iter2>{})
+																												&& !std::is_const<typename type::Iterator_traits<Iter1>::value_type>::value>());
 	}			
-}
-//---NS lib_impl
-//-- User library
-namespace
-lib
-{
-	// type checking
-	
-	template<class T,
-					std::size_t n>
+	// Thread pool
+	// A fixed set of workers, started on first use and pinned one per
+	// allowed CPU (LIB_PIN=0 leaves them floating). LIB_THREADS sets the
+	// concurrency, else the hardware threads; the workers are one less,
+	// at least one, the thread joining a Fork_join being the last.
+	// Each worker has its own deque of tasks: it pushes and pops at the
+	// back and, when empty, steals from the front of the others.
+	// Threads outside the pool submit round robin.
+	// Tasks are intrusive nodes owned by the submitter, which may take
+	// back the ones not yet started.
 	class
-	Array
+	Thread_pool
 	{
-      // MISRA C++
-      // Rule 16–0–4
-      // Function-like macros shall not be defined.
-      // used inline functions instead for safer type checking of parameters.
-
-			// Concept requirements 
-			typedef T* iter;
-      typedef Array<T,n> Array_t; 
-        // Member functions of a local class are implicitly inline functions.
-      static
-      void 
-      M_constraints() 
-      {
-        // Requirements for element type T used by Array
-        type::__function_requires< type::SGIAssignableConcept<T> >();
-        type::__function_requires< type::RandomAccessIteratorConcept<iter> >();
-        // Requirements for the container Array
-        type::__function_requires< type::ContainerConcept<Array_t> >();   
-      }
-      typedef type::_class_requires< &M_constraints > _concept_requirements;
-
 		public:
-    	using size_type                              = std::size_t;
-    	using value_type                             = T;	
-    	using difference_type                        = std::ptrdiff_t;
-    	using reference															 = T&;
-    	using const_reference												 = const T&;    	
-    	using pointer																 = T*;
-    	using const_pointer													 = const T*;
-    	using iterator 															 = T*;
-    	using const_iterator												 = const T*;	
-    	using reverse_iterator											 = std::reverse_iterator<iterator>;
-    	using const_reverse_iterator								 = std::reverse_iterator<const_iterator>;
+			struct Queue;
+			struct
+			Task
+			{
+				void (*run)(Task*);
+				Task* prev;
+				Task* next;
+				Queue* queue;
+			};
+			struct
+			alignas(64)
+			Queue
+			{
+				std::mutex lock;
+				Task* head;
+				Task* tail;
+			};
 
-			Array()
-      {
-      }
-      // AUTOSAR C++
-      // Compliant Rule A12-0-1
-      // “the rule of zero”
-      // five special member functions
-      // - copy and move constructor
+			static
+			Thread_pool&
+			instance()
+			{
+				static Thread_pool pool;
+				return pool;
+			}
+			// Workers
+			std::size_t
+			size() const
+			noexcept
+			{
+				return M_count;
+			}
+			// Threads a Fork_join may use
+			std::size_t
+			concurrency() const
+			noexcept
+			{
+				return M_concurrency;
+			}
+			void
+			submit(Task* t)
+			{
+				const std::size_t self = M_self;
+				Queue& q = M_queues[self < M_count ? self 
+																						: M_next.fetch_add(1, std::memory_order_relaxed) % M_count];
+				{
+					std::lock_guard<std::mutex> guard(q.lock);
+					t->queue = &q;
+					t->prev = q.tail;
+					t->next = 0;
+					(q.tail ? q.tail->next : q.head) = t;
+					q.tail = t;
+					M_queued.fetch_add(1);
+				}
+				if (M_sleeping.load() != 0)
+				{
+					std::lock_guard<std::mutex> guard(M_sleep_lock);
+					M_wake.notify_one();
+				}
+			}
+			// true when t was still queued and is now removed
+			bool
+			cancel(Task* t)
+			noexcept
+			{
+				Queue& q = *t->queue;
+				std::lock_guard<std::mutex> guard(q.lock);
+				if (t->prev == t)
+				{
+					// taken by a worker
+					return false;
+				}
+				M_unlink(q, t);
+				return true;
+			}
+			// Runs one queued task on the calling thread, own deque first
+			bool
+			run_one()
+			{
+				const std::size_t self = M_self;
+				Task* t = (self < M_count ? M_take(M_queues[self], true) : 0);
+				const std::size_t start = (self < M_count ? self 
+																									: M_next.load(std::memory_order_relaxed));
+				for (std::size_t i = 1; !t && i <= M_count; ++i)
+				{
+					t = M_take(M_queues[(start + i) % M_count], false);
+				}
+				if (!t)
+				{
+					return false;
+				}
+				t->run(t);
+				return true;
+			}
+			// Queued tasks still run before the workers exit
+			~Thread_pool()
+			{
+				{
+					std::lock_guard<std::mutex> guard(M_sleep_lock);
+					M_stop = true;
+				}
+				M_wake.notify_all();
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_threads[i].join();
+				}
+			}
+		private:
+			Thread_pool()
+				: M_concurrency(M_default_concurrency()), 
+					M_count(M_concurrency > 1 ? M_concurrency - 1 : 1),
+					M_queued(0), M_sleeping(0), M_next(0), M_stop(false)
+			{
+				M_queues.reset(new Queue[M_count]);
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_queues[i].head = 0;
+					M_queues[i].tail = 0;
+				}
+				M_threads.reset(new std::thread[M_count]);
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_threads[i] = std::thread(&Thread_pool::M_work, this, i);
+				}
+			}
+			Thread_pool(const Thread_pool&) = delete;
+			Thread_pool& operator=(const Thread_pool&) = delete;
+
+			static
+			std::size_t
+			M_default_concurrency()
+			{
+				const char* env = std::getenv("LIB_THREADS");
+				if (env)
+				{
+					const long n = std::strtol(env, 0, 10);
+					return (n > 1 ? std::size_t(n) : 1);
+				}
+				const unsigned hw = std::thread::hardware_concurrency();
+				return (hw > 1 ? hw : 1);
+			}
+			// Worker i on the (i + 1)th allowed CPU, the first one is 
+			// left to the thread which started the pool
+			static
+			void
+			M_pin(std::size_t i)
+			noexcept
+			{
+#if defined(__linux__)
+				const char* env = std::getenv("LIB_PIN");
+				cpu_set_t allowed;
+				if ((env && std::strcmp(env, "0") == 0) 
+						|| sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+				{
+					return;
+				}
+				const int cpus = CPU_COUNT(&allowed);
+				int k = int((i + 1) % std::size_t(cpus));
+				for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+				{
+					if (CPU_ISSET(cpu, &allowed) && k-- == 0)
+					{
+						cpu_set_t one;
+						CPU_ZERO(&one);
+						CPU_SET(cpu, &one);
+						static_cast<void>(pthread_setaffinity_np(pthread_self(), sizeof(one), &one));
+						return;
+					}
+				}
+#else
+				static_cast<void>(i);
+#endif
+			}
+			// Marks t as taken, q locked
+			void
+			M_unlink(Queue& q, 
+								Task* t)
+			noexcept
+			{
+				(t->prev ? t->prev->next : q.head) = t->next;
+				(t->next ? t->next->prev : q.tail) = t->prev;
+				t->prev = t;
+				M_queued.fetch_sub(1);
+			}
+			Task*
+			M_take(Queue& q, 
+							bool back)
+			noexcept
+			{
+				std::lock_guard<std::mutex> guard(q.lock);
+				Task* t = (back ? q.tail : q.head);
+				if (t)
+				{
+					M_unlink(q, t);
+				}
+				return t;
+			}
+			void
+			M_work(std::size_t i)
+			{
+				M_self = i;
+				M_pin(i);
+				for (;;)
+				{
+					if (run_one())
+					{
+						continue;
+					}
+					std::unique_lock<std::mutex> guard(M_sleep_lock);
+					M_sleeping.fetch_add(1);
+					M_wake.wait(guard, [this]{ return M_queued.load() != 0 || M_stop; });
+					M_sleeping.fetch_sub(1);
+					if (M_queued.load() == 0)
+					{
+						return;
+					}
+				}
+			}
+
+			const std::size_t M_concurrency;
+			const std::size_t M_count;
+			std::unique_ptr<Queue[]> M_queues;
+			std::unique_ptr<std::thread[]> M_threads;
+			std::atomic<std::size_t> M_queued;
+			std::atomic<std::size_t> M_sleeping;
+			std::atomic<std::size_t> M_next;
+			std::mutex M_sleep_lock;
+			std::condition_variable M_wake;
+			bool M_stop;
+			// Worker index of the calling thread, size() elsewhere
+			static thread_local std::size_t M_self;
+	};
+	thread_local std::size_t Thread_pool::M_self = std::size_t(-1);
+
+	// Futures
+	// Tasks on the pool hand their result, or the exception they threw,
+	// to a std::promise, as set_value and set_exception do across threads.
+	template <typename F, 
+							typename R>
+	struct
+	Async_task
+		: Thread_pool::Task
+	{
+		explicit
+		Async_task(F&& f)
+			: fn(std::move(f))
+		{
+			run = &M_run;
+		}
+		static
+		void
+		M_set(Async_task& a, 
+					type::true_type)
+		{
+			a.fn();
+			a.prom.set_value();
+		}
+		static
+		void
+		M_set(Async_task& a, 
+					type::false_type)
+		{
+			a.prom.set_value(a.fn());
+		}
+		static
+		void
+		M_run(Thread_pool::Task* t)
+		{
+			std::unique_ptr<Async_task> self(static_cast<Async_task*>(t));
+			try
+			{
+				M_set(*self, type::__bool_constant<std::is_void<R>::value>());
+			}
+			catch (...)
+			{
+				try
+				{
+					self->prom.set_exception(std::current_exception());
+				}
+				catch (...)
+				{
+					// set_exception() may throw too
+				}
+			}
+		}
+
+		F fn;
+		std::promise<R> prom;
+	};
+	// Runs f() on the pool
+	template <typename F>
+	std::future<decltype(std::declval<F&>()())>
+	async(F f)
+	{
+		typedef decltype(std::declval<F&>()()) R;
+		Async_task<F, R>* a = new Async_task<F, R>(std::move(f));
+		std::future<R> fut = a->prom.get_future();
+		Thread_pool::instance().submit(a);
+		return fut;
+	}
+	// Blocks until f is ready, running queued tasks meanwhile so a
+	// worker waiting on work it spawned cannot starve the pool
+	template <typename R>
+	void
+	wait(std::future<R>& f)
+	{
+		Thread_pool& pool = Thread_pool::instance();
+		while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!pool.run_one())
+			{
+				f.wait_for(std::chrono::microseconds(100));
+			}
+		}
+	}
+	template <typename R, 
+							typename... Rs>
+	void
+	wait(std::future<R>& f, 
+				std::future<Rs>&... fs)
+	{
+		lib_impl::wait(f);
+		lib_impl::wait(fs...);
+	}
+	// Ready once all of fs are, which keep their values or exceptions
+	template <typename... Rs>
+	std::future<std::tuple<std::future<Rs>...>>
+	when_all(std::future<Rs>... fs)
+	{
+		return lib_impl::async(
+						[all = std::make_tuple(std::move(fs)...)]() mutable
+						{
+							std::apply([](std::future<Rs>&... f){ lib_impl::wait(f...); }, all);
+							return std::move(all);
+						});
+	}
+
+	// Fork-join over the Thread_pool
+	// body(slot, chunk) runs for every chunk in [0, chunks), claimed in
+	// order from a shared counter by the caller and up to slots() - 1
+	// helpers queued on the pool, slot numbering the participant from 0
+	// (the caller). Idle workers steal the helpers.
+	// The first exception stops further claims and is rethrown.
+	// Callers never wait for queued work, so nested use cannot deadlock.
+	class
+	Fork_join
+	{
+		public:
+			static
+			std::size_t
+			slots(std::size_t chunks)
+			noexcept
+			{
+				const std::size_t n = Thread_pool::instance().concurrency();
+				return (chunks < n ? chunks : n);
+			}
+			template <typename Body>
+			static
+			void
+			run(std::size_t chunks, 
+					Body& body)
+			{
+				if (slots(chunks) < 2)
+				{
+					for (std::size_t c = 0; c != chunks; ++c)
+					{
+						body(std::size_t(0), c);
+					}
+					return;
+				}
+				Job job(chunks, &M_call<Body>, &body);
+				M_run(job, slots(chunks));
+			}
+		private:
+			struct
+			Job
+			{
+				Job(std::size_t n, 
+						void (*f)(void*, std::size_t, std::size_t), 
+						void* b)
+					: call(f), body(b), chunks(n), next(0), failed(false), active(0)
+				{
+				}
+				void (*call)(void*, std::size_t, std::size_t);
+				void* body;
+				std::size_t chunks;
+				std::atomic<std::size_t> next;
+				std::atomic<bool> failed;
+				std::exception_ptr error;
+				std::mutex lock;
+				std::condition_variable done;
+				std::size_t active;
+			};
+			struct
+			Helper
+				: Thread_pool::Task
+			{
+				Job* job;
+				std::size_t slot;
+			};
+
+			template <typename Body>
+			static
+			void
+			M_call(void* body, 
+							std::size_t slot, 
+							std::size_t chunk)
+			{
+				(*static_cast<Body*>(body))(slot, chunk);
+			}
+			static
+			void
+			M_claim(Job& job, 
+								std::size_t slot)
+			noexcept
+			{
+				std::size_t c;
+				while (!job.failed.load(std::memory_order_relaxed)
+							 && (c = job.next.fetch_add(1, std::memory_order_relaxed)) < job.chunks)
+				{
+					try
+					{
+						job.call(job.body, slot, c);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> guard(job.lock);
+						if (!job.error)
+						{
+							job.error = std::current_exception();
+						}
+						job.failed.store(true, std::memory_order_relaxed);
+					}
+				}
+			}
+			static
+			void
+			M_help(Thread_pool::Task* t)
+			{
+				Helper* h = static_cast<Helper*>(t);
+				Job& job = *h->job;
+				M_claim(job, h->slot);
+				std::lock_guard<std::mutex> guard(job.lock);
+				if (--job.active == 0)
+				{
+					job.done.notify_one();
+				}
+			}
+			static
+			void
+			M_run(Job& job, 
+						std::size_t slots)
+			{
+				Thread_pool& pool = Thread_pool::instance();
+				const std::size_t helpers = slots - 1;
+				std::unique_ptr<Helper[]> help(new Helper[helpers]);
+				job.active = helpers;
+				for (std::size_t i = 0; i != helpers; ++i)
+				{
+					help[i].run = &M_help;
+					help[i].job = &job;
+					help[i].slot = i + 1;
+					pool.submit(&help[i]);
+				}
+				M_claim(job, 0);
+				std::size_t taken = 0;
+				for (std::size_t i = 0; i != helpers; ++i)
+				{
+					taken += pool.cancel(&help[i]);
+				}
+				std::unique_lock<std::mutex> guard(job.lock);
+				job.active -= taken;
+				job.done.wait(guard, [&job]{ return job.active == 0; });
+				if (job.error)
+				{
+					std::rethrow_exception(job.error);
+				}
+			}
+	};
+	// Parallel reduction of element(i) for i in [0, n) with red.
+	// Chunks start from their first element, init joins first when the
+	// chunk results are combined.
+	template <typename T, 
+							typename Element,
+							typename ReduceOp>
+	T
+	parallel_reduce(bool deterministic, 
+										std::size_t n, 
+										std::size_t grain, 
+										T init, 
+										ReduceOp red, 
+										Element element)
+	{
+		const std::size_t chunks = (n + grain - 1) / grain;
+		// one result per chunk, or per participant in any order
+		const std::size_t parts = (deterministic ? chunks : Fork_join::slots(chunks));
+		std::unique_ptr<std::optional<T>[]> part(new std::optional<T>[parts]);
+		auto 
+		body = 
+		[&](std::size_t slot, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			T acc = element(c * grain);
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = red(std::move(acc), element(i));
+			}
+			std::optional<T>& p = part[deterministic ? c : slot];
+			if (p)
+			{
+				*p = red(std::move(*p), std::move(acc));
+			}
+			else
+			{
+				p.emplace(std::move(acc));
+			}
+		};
+		lib_impl::Fork_join::run(chunks, body);
+		for (std::size_t i = 0; i != parts; ++i)
+		{
+			if (part[i])
+			{
+				init = red(std::move(init), std::move(*part[i]));
+			}
+		}
+		return init;
+	}
+	// CRC-32C (Castagnoli) of a byte range, with the SSE4.2 crc32
+	// instruction when the CPU has it, else one table lookup per byte.
+	// crc chains the result of a previous call.
+	class
+	Crc32c
+	{
+		public:
+			static
+			std::uint32_t
+			compute(const void* p, 
+							std::size_t n, 
+							std::uint32_t crc = 0)
+			{
+				return ~M_kernel()(~crc, static_cast<const unsigned char*>(p), n);
+			}
+		private:
+			typedef std::uint32_t (*Kernel)(std::uint32_t, const unsigned char*, std::size_t);
+			struct
+			Table
+			{
+				std::uint32_t entries[256];
+
+				Table()
+				{
+					for (std::uint32_t i = 0; i != 256; ++i)
+					{
+						std::uint32_t c = i;
+						for (int k = 0; k != 8; ++k)
+						{
+							c = (c & 1 ? (c >> 1) ^ 0x82F63B78u : c >> 1);
+						}
+						entries[i] = c;
+					}
+				}
+			};
+			static
+			Kernel
+			M_kernel()
+			{
+				static const Kernel kernel = M_select();
+				return kernel;
+			}
+			static
+			Kernel
+			M_select()
+			{
+#if LIB_SIMD && defined(__x86_64__)
+				if (__builtin_cpu_supports("sse4.2"))
+				{
+					return &M_sse42;
+				}
+#endif
+				return &M_scalar;
+			}
+			static
+			std::uint32_t
+			M_scalar(std::uint32_t crc, 
+								const unsigned char* p, 
+								std::size_t n)
+			{
+				static const Table table;
+				for (; n != 0; --n, ++p)
+				{
+					crc = table.entries[(crc ^ *p) & 0xFFu] ^ (crc >> 8);
+				}
+				return crc;
+			}
+#if LIB_SIMD && defined(__x86_64__)
+			_Target_sse42
+			static
+			std::uint32_t
+			M_sse42(std::uint32_t crc, 
+							const unsigned char* p, 
+							std::size_t n)
+			{
+				std::uint64_t c = crc;
+				for (; n >= 8; n -= 8, p += 8)
+				{
+					std::uint64_t w;
+					std::memcpy(&w, p, 8);
+					c = _mm_crc32_u64(c, w);
+				}
+				crc = std::uint32_t(c);
+				for (; n != 0; --n, ++p)
+				{
+					crc = _mm_crc32_u8(crc, *p);
+				}
+				return crc;
+			}
+#endif
+	};
+
+	// Binary format
+	// A 64 byte header, padding up to the element alignment, then the
+	// element bytes as they are in memory. Only trivially copyable
+	// elements, read back on a machine of the same byte order.
+	struct
+	Binary_header
+	{
+		char magic[4];
+		std::uint16_t version;
+		// 0x0102 as written, 0x0201 from the other byte order
+		std::uint16_t endian;
+		std::uint32_t type_tag;
+		std::uint32_t alignment;
+		std::uint64_t count;
+		// bytes from the start of the header to the elements
+		std::uint64_t data_offset;
+		// CRC-32C of the element bytes
+		std::uint32_t checksum;
+		// CRC-32C of the header up to this field
+		std::uint32_t header_checksum;
+		char reserved[24];
+	};
+	static_assert(sizeof(Binary_header) == 64, "Binary_header is 64 bytes");
+
+	// Element type tag, kind in the high byte and the size below:
+	// 1 signed, 2 unsigned integral, 3 floating point, 0 other.
+	// Specialize to tell apart other types of the same size.
+	template <typename T>
+	struct
+	Binary_tag
+	{
+		static constexpr std::uint32_t value = 
+			(std::uint32_t(std::is_floating_point<T>::value ? 3 
+											: !std::is_integral<T>::value ? 0 
+											: std::is_signed<T>::value ? 1 : 2) << 24)
+			| std::uint32_t(sizeof(T) & 0xFFFFFFu);
+	};
+
+	template <typename T>
+	Binary_header
+	make_binary_header(const T* p, 
+											std::size_t n)
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+									"binary format elements are their bytes");
+		Binary_header h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, "LIBB", 4);
+		h.version = 1;
+		h.endian = 0x0102;
+		h.type_tag = Binary_tag<T>::value;
+		h.alignment = alignof(T);
+		h.count = n;
+		h.data_offset = (sizeof(h) + alignof(T) - 1) / alignof(T) * alignof(T);
+		h.checksum = Crc32c::compute(p, n * sizeof(T));
+		h.header_checksum = Crc32c::compute(&h, offsetof(Binary_header, header_checksum));
+		return h;
+	}
+	// Throws unless h holds elements of T
+	template <typename T>
+	void
+	check_binary_header(const Binary_header& h)
+	{
+		if (std::memcmp(h.magic, "LIBB", 4) != 0)
+		{
+			throw std::runtime_error{"binary image header is corrupt"};
+		}
+		if (h.endian != 0x0102)
+		{
+			throw std::runtime_error{"binary image has the other byte order"};
+		}
+		if (h.version != 1
+				|| h.header_checksum != Crc32c::compute(&h, offsetof(Binary_header, header_checksum)))
+		{
+			throw std::runtime_error{"binary image header is corrupt"};
+		}
+		if (h.type_tag != Binary_tag<T>::value || h.alignment != alignof(T)
+				|| h.data_offset < sizeof(h) || h.data_offset % alignof(T) != 0
+				|| h.count > std::size_t(-1) / sizeof(T))
+		{
+			throw std::runtime_error{"binary image element type mismatch"};
+		}
+	}
+	// Writes all of v[0, left), resumed after a partial write
+	inline
+	void
+	writev_exactly(int fd, 
+									struct iovec* v, 
+									int left)
+	{
+		while (left != 0)
+		{
+			const ssize_t w = ::writev(fd, v, left);
+			if (w < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				throw std::runtime_error{"write_binary failed"};
+			}
+			std::size_t done = std::size_t(w);
+			for (; left != 0 && done >= v->iov_len; --left, ++v)
+			{
+				done -= v->iov_len;
+			}
+			if (left != 0)
+			{
+				v->iov_base = static_cast<char*>(v->iov_base) + done;
+				v->iov_len -= done;
+			}
+		}
+	}
+	// Header, padding and elements in one writev. Alignments above
+	// 128 need more padding than one slice, written before the elements.
+	inline
+	void
+	write_binary(int fd, 
+								const Binary_header& h, 
+								const void* data)
+	{
+		static const char padding[64] = {};
+		std::size_t pad = std::size_t(h.data_offset) - sizeof(h);
+		const std::size_t bytes = std::size_t(h.count) * (h.type_tag & 0xFFFFFFu);
+		struct iovec iov[3] = {{const_cast<Binary_header*>(&h), sizeof(h)},
+														{const_cast<char*>(padding), (pad < sizeof(padding) ? pad : sizeof(padding))},
+														{const_cast<void*>(data), bytes}};
+		if (pad <= sizeof(padding))
+		{
+			writev_exactly(fd, iov, 3);
+			return;
+		}
+		writev_exactly(fd, iov, 2);
+		for (pad -= sizeof(padding); pad != 0; )
+		{
+			struct iovec slice = {const_cast<char*>(padding), (pad < sizeof(padding) ? pad : sizeof(padding))};
+			pad -= slice.iov_len;
+			writev_exactly(fd, &slice, 1);
+		}
+		writev_exactly(fd, iov + 2, 1);
+	}
+	inline
+	void
+	read_exactly(int fd, 
+								void* p, 
+								std::size_t n)
+	{
+		char* dst = static_cast<char*>(p);
+		while (n != 0)
+		{
+			const ssize_t r = ::read(fd, dst, n);
+			if (r < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (r <= 0)
+			{
+				throw std::runtime_error{"read_binary truncated image"};
+			}
+			dst += r;
+			n -= std::size_t(r);
+		}
+	}
+	// Reads an image of T from fd: header then elements into the
+	// storage from alloc(count), checked against the checksum
+	template <typename T, 
+							typename Alloc>
+	void
+	read_binary(int fd, 
+							Alloc alloc)
+	{
+		Binary_header h;
+		read_exactly(fd, &h, sizeof(h));
+		check_binary_header<T>(h);
+		char padding[64];
+		for (std::size_t pad = std::size_t(h.data_offset) - sizeof(h); pad != 0; )
+		{
+			const std::size_t n = (pad < sizeof(padding) ? pad : sizeof(padding));
+			read_exactly(fd, padding, n);
+			pad -= n;
+		}
+		// A regular file must hold count elements before they are allocated
+		struct stat st;
+		const off_t at = ::lseek(fd, 0, SEEK_CUR);
+		if (at >= 0 && ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+				&& (st.st_size < at || h.count > std::uint64_t(st.st_size - at) / sizeof(T)))
+		{
+			throw std::runtime_error{"read_binary truncated image"};
+		}
+		T* data = alloc(std::size_t(h.count));
+		read_exactly(fd, data, std::size_t(h.count) * sizeof(T));
+		if (Crc32c::compute(data, std::size_t(h.count) * sizeof(T)) != h.checksum)
+		{
+			throw std::runtime_error{"binary image checksum mismatch"};
+		}
+	}
+	// Elements of T in a buffer holding a whole image
+	template <typename T>
+	const T*
+	binary_elements(const void* buffer, 
+										std::size_t bytes, 
+										std::size_t& count, 
+										bool verify)
+	{
+		if (bytes < sizeof(Binary_header))
+		{
+			throw std::runtime_error{"binary image truncated"};
+		}
+		Binary_header h;
+		std::memcpy(&h, buffer, sizeof(h));
+		check_binary_header<T>(h);
+		if (h.data_offset > bytes || h.count > (bytes - h.data_offset) / sizeof(T))
+		{
+			throw std::runtime_error{"binary image truncated"};
+		}
+		const char* data = static_cast<const char*>(buffer) + h.data_offset;
+		if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
+		{
+			throw std::runtime_error{"binary image misaligned"};
+		}
+		if (verify && Crc32c::compute(data, std::size_t(h.count) * sizeof(T)) != h.checksum)
+		{
+			throw std::runtime_error{"binary image checksum mismatch"};
+		}
+		count = std::size_t(h.count);
+		return reinterpret_cast<const T*>(data);
+	}
+	// Heap use of the program, counted in the global operator new
+	class
+	Alloc_count
+	{
+		public:
+			static
+			void
+			record(std::size_t sz)
+			noexcept
+			{
+				M_allocations.fetch_add(1, std::memory_order_relaxed);
+				M_bytes.fetch_add(sz, std::memory_order_relaxed);
+			}
+			static
+			std::uint64_t
+			allocations()
+			{
+				return M_allocations.load(std::memory_order_relaxed);
+			}
+			static
+			std::uint64_t
+			bytes()
+			{
+				return M_bytes.load(std::memory_order_relaxed);
+			}
+		private:
+			// Constant initialized, usable before any dynamic initialization
+			static std::atomic<std::uint64_t> M_allocations;
+			static std::atomic<std::uint64_t> M_bytes;
+	};
+	std::atomic<std::uint64_t> Alloc_count::M_allocations{0};
+	std::atomic<std::uint64_t> Alloc_count::M_bytes{0};
+}
+//---NS lib_impl
+
+// Global scope
+
+// The program is ill-formed if a replacement is defined in namespace other than global namespace,
+// or if it is defined as a static non-member function at global scope. 
+// no inline, required by [replacement.functions]
+_Noinline
+void* 
+operator 
+new(std::size_t sz)
+{
+  // avoid std::malloc(0) which may return nullptr on success
+  if (sz == 0)
+      ++sz; 
+
+  void* ptr = std::malloc(sz);
+  if (ptr)
+  {
+      lib_impl::Alloc_count::record(sz);
+      return ptr;
+  }
+	// required by [new.delete.single]
+  throw std::bad_alloc{}; 
+}
+ 
+// no inline, required by [replacement.functions]
+_Noinline
+void* 
+operator 
+new[](std::size_t sz)
+{
+  if (sz == 0)
+      ++sz; 
+
+  void* ptr = std::malloc(sz);
+  if (ptr)
+  {
+      lib_impl::Alloc_count::record(sz);
+      return ptr;
+  }
+
+  throw std::bad_alloc{}; 
+}
+ 
+_Noinline
+void 
+operator 
+delete(void* ptr) 
+noexcept
+{
+    std::free(ptr);
+}
+ 
+_Noinline
+void 
+operator 
+delete(void* ptr, 
+			std::size_t) 
+noexcept
+{
+    std::free(ptr);
+}
+ 
+_Noinline
+void 
+operator 
+delete[](void* ptr) 
+noexcept
+{
+    std::free(ptr);
+}
+ 
+_Noinline
+void 
+operator 
+delete[](void* ptr, 
+				std::size_t) 
+noexcept
+{
+    std::free(ptr);
+}
+//---End Global Namespace
+//-- User library
+namespace
+lib
+{
+	// type checking
+	
+	template<class T,
+					std::size_t n>
+	class
+	Array
+	{
+      // MISRA C++
+      // Rule 16–0–4
+      // Function-like macros shall not be defined.
+      // used inline functions instead for safer type checking of parameters.
+
+			// Concept requirements 
+			typedef T* iter;
+      typedef Array<T,n> Array_t; 
+        // Member functions of a local class are implicitly inline functions.
+      static
+      void 
+      M_constraints() 
+      {
+        // Requirements for element type T used by Array
+        type::__function_requires< type::SGIAssignableConcept<T> >();
+        type::__function_requires< type::ContiguousIteratorConcept<iter> >();
+        // Requirements for the container Array
+        type::__function_requires< type::ContainerConcept<Array_t> >();   
+      }
+      typedef type::_class_requires< &M_constraints > _concept_requirements;
+
+		public:
+    	using size_type                              = std::size_t;
+    	using value_type                             = T;	
+    	using difference_type                        = std::ptrdiff_t;
+    	using reference															 = T&;
+    	using const_reference												 = const T&;    	
+    	using pointer																 = T*;
+    	using const_pointer													 = const T*;
+    	using iterator 															 = T*;
+    	using const_iterator												 = const T*;	
+    	using reverse_iterator											 = std::reverse_iterator<iterator>;
+    	using const_reverse_iterator								 = std::reverse_iterator<const_iterator>;
+
+			Array()
+      {
+      }
+      // AUTOSAR C++
+      // Compliant Rule A12-0-1
+      // “the rule of zero”
+      // five special member functions
+      // - copy and move constructor
       // - copy and move assignment
       // - destructor
 
@@ -727,7 +2390,7 @@ lib
     	void
     	swap(Array& other)
     	{
-    		M_swap_array(other.begin()); 
+    		M_swap_array(other); 
     	} 
     	void
     	fill(const value_type& val)
@@ -773,7 +2436,7 @@ lib
 	operator==(const Array<T, n>& lhs, 
 						const Array<T, n>& rhs)
 	{
-		return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+		return lib_impl::equal(lhs.begin(), lhs.end(), rhs.begin());
 	}
 	template<typename T, 
 					std::size_t n>
@@ -791,7 +2454,7 @@ lib
 	operator<(const Array<T, n>& lhs, 
 						const Array<T, n>& rhs)
 	{
-		return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); 
+		return lib_impl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()); 
 	}
 	template<typename T, 
 					std::size_t n>		
@@ -824,11 +2487,444 @@ lib
 					std::size_t n>		
 	inline 
 	void
-	swap(const Array<T, n>& arr1, 
-						const Array<T, n>& arr2)
+	swap(Array<T, n>& arr1, 
+						Array<T, n>& arr2)
 	{
 		return arr1.swap(arr2);
 	}				
+	
+	// Binary images of Arrays, see lib_impl::Binary_header
+	template <typename T, 
+						std::size_t n>
+	void
+	write_binary(int fd, 
+								const Array<T, n>& arr)
+	{
+		lib_impl::write_binary(fd, lib_impl::make_binary_header(arr.data(), n), arr.data());
+	}
+	// The image must hold n elements, read straight into arr
+	template <typename T, 
+						std::size_t n>
+	void
+	read_binary(int fd, 
+							Array<T, n>& arr)
+	{
+		lib_impl::read_binary<T>(fd, 
+														[&arr](std::size_t count) -> T*
+														{
+															if (count != n)
+															{
+																throw std::runtime_error{"read_binary Array size mismatch"};
+															}
+															return arr.data();
+														});
+	}
+	// Binary view
+	// Read-only elements of a binary image, in a buffer of the caller
+	// or in a file mapped privately, pages read on first use. 
+	// Nothing is parsed or copied; verify reads every byte once to
+	// check the checksum.
+	template <typename T>
+	class
+	Binary_view
+	{
+		public:
+			using value_type							= T;
+			using size_type								= std::size_t;
+			using const_reference					= const T&;
+			using const_pointer						= const T*;
+			using const_iterator					= const T*;
+
+			// buffer must outlive the view
+			Binary_view(const void* buffer, 
+									std::size_t bytes, 
+									bool verify = true)
+				: M_data(lib_impl::binary_elements<T>(buffer, bytes, M_size, verify))
+			{
+			}
+			static
+			Binary_view
+			map(const char* path, 
+					bool verify = true)
+			{
+				const int fd = ::open(path, O_RDONLY);
+				struct stat st;
+				if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size == 0)
+				{
+					if (fd >= 0)
+						::close(fd);
+					throw std::runtime_error{"Binary_view cannot open file"};
+				}
+				const std::size_t bytes = std::size_t(st.st_size);
+				void* p = ::mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+				::close(fd);
+				if (p == MAP_FAILED)
+				{
+					throw std::runtime_error{"Binary_view cannot map file"};
+				}
+				try
+				{
+					Binary_view view(p, bytes, verify);
+					view.M_map = p;
+					view.M_map_bytes = bytes;
+					return view;
+				}
+				catch (...)
+				{
+					::munmap(p, bytes);
+					throw;
+				}
+			}
+			Binary_view(Binary_view&& other)
+			noexcept
+				: M_size(other.M_size), M_data(other.M_data), 
+					M_map(other.M_map), M_map_bytes(other.M_map_bytes)
+			{
+				other.M_map = 0;
+			}
+			Binary_view(const Binary_view&) = delete;
+			Binary_view& operator=(const Binary_view&) = delete;
+			~Binary_view()
+			{
+				if (M_map)
+				{
+					::munmap(M_map, M_map_bytes);
+				}
+			}
+			const_pointer
+			data() const
+			noexcept
+			{
+				return M_data;
+			}
+			size_type
+			size() const
+			noexcept
+			{
+				return M_size;
+			}
+			bool
+			empty() const
+			noexcept
+			{
+				return (M_size == 0);
+			}
+			const_reference
+			operator[](size_type n) const
+			noexcept
+			{
+				return M_data[n];
+			}
+			const_iterator
+			begin() const
+			noexcept
+			{
+				return M_data;
+			}
+			const_iterator
+			end() const
+			noexcept
+			{
+				return M_data + M_size;
+			}
+		private:
+			// set by the constructor of M_data
+			std::size_t M_size;
+			const T* M_data;
+			void* M_map{0};
+			std::size_t M_map_bytes{0};
+	};
+	
+	// Parallel algorithms
+	// Random access ranges are cut into chunks of grain elements, by
+	// default as many as fill chunk_bytes, and run on lib_impl::Fork_join.
+	// Deterministic reductions combine chunk results in chunk order, so
+	// the result depends on the grain only, not on the thread count.
+	// Scans are always deterministic.
+	class
+	Parallel_policy
+	{
+		public:
+			static constexpr std::size_t chunk_bytes = 32 * 1024;
+
+			constexpr
+			Parallel_policy() noexcept
+				: M_grain(0), M_deterministic(false)
+			{
+			}
+			// 0 selects cache sized chunks
+			constexpr
+			Parallel_policy
+			grain(std::size_t n) const
+			noexcept
+			{
+				return Parallel_policy(n, M_deterministic);
+			}
+			constexpr
+			Parallel_policy
+			deterministic(bool on = true) const
+			noexcept
+			{
+				return Parallel_policy(M_grain, on);
+			}
+			constexpr
+			bool
+			is_deterministic() const
+			noexcept
+			{
+				return M_deterministic;
+			}
+			template <typename T>
+			constexpr
+			std::size_t
+			grain_for() const
+			noexcept
+			{
+				return (M_grain ? M_grain 
+												: (sizeof(T) < chunk_bytes ? chunk_bytes / sizeof(T) : 1));
+			}
+		private:
+			constexpr
+			Parallel_policy(std::size_t n, 
+											bool on) noexcept
+				: M_grain(n), M_deterministic(on)
+			{
+			}
+
+			std::size_t M_grain;
+			bool M_deterministic;
+	};
+	constexpr Parallel_policy par{};
+
+	template <typename RandomIt, 
+							typename Function>
+	void
+	for_each(const Parallel_policy& policy, 
+						RandomIt first, 
+						RandomIt last, 
+						Function f)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				f(first[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+	}
+	template <typename RandomIt, 
+							typename OutputIt,
+							typename UnaryOp>
+	OutputIt
+	transform(const Parallel_policy& policy, 
+						RandomIt first, 
+						RandomIt last, 
+						OutputIt result, 
+						UnaryOp op)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				result[i] = op(first[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+		return result + n;
+	}
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename OutputIt,
+							typename BinaryOp>
+	OutputIt
+	transform(const Parallel_policy& policy, 
+						RandomIt1 first1, 
+						RandomIt1 last1, 
+						RandomIt2 first2, 
+						OutputIt result, 
+						BinaryOp op)
+	{
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type;
+		const std::size_t n = std::size_t(last1 - first1);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				result[i] = op(first1[i], first2[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+		return result + n;
+	}
+	template <typename RandomIt, 
+							typename T,
+							typename BinaryOp>
+	T
+	reduce(const Parallel_policy& policy, 
+					RandomIt first, 
+					RandomIt last, 
+					T init, 
+					BinaryOp op)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last - first), 
+																policy.grain_for<Value_type>(), std::move(init), op,
+																[&](std::size_t i) -> T { return first[i]; });
+	}
+	template <typename RandomIt, 
+							typename T>
+	T
+	reduce(const Parallel_policy& policy, 
+					RandomIt first, 
+					RandomIt last, 
+					T init)
+	{
+		return lib::reduce(policy, first, last, std::move(init), 
+												[](T a, const T& b) -> T { return a + b; });
+	}
+	template <typename RandomIt, 
+							typename T,
+							typename ReduceOp,
+							typename TransformOp>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt first, 
+										RandomIt last, 
+										T init, 
+										ReduceOp red,
+										TransformOp tr)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last - first), 
+																policy.grain_for<Value_type>(), std::move(init), red,
+																[&](std::size_t i) -> T { return tr(first[i]); });
+	}
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename T,
+							typename ReduceOp,
+							typename TransformOp>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt1 first1, 
+										RandomIt1 last1, 
+										RandomIt2 first2, 
+										T init, 
+										ReduceOp red,
+										TransformOp tr)
+	{
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last1 - first1), 
+																policy.grain_for<Value_type>(), std::move(init), red,
+																[&](std::size_t i) -> T { return tr(first1[i], first2[i]); });
+	}
+	// Inner product
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename T>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt1 first1, 
+										RandomIt1 last1, 
+										RandomIt2 first2, 
+										T init)
+	{
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type1;
+		typedef typename type::Iterator_traits<RandomIt2>::value_type Value_type2;
+		return lib::transform_reduce(policy, first1, last1, first2, std::move(init), 
+																	[](T a, const T& b) -> T { return a + b; },
+																	[](const Value_type1& a, const Value_type2& b) -> T { return a * b; });
+	}
+	// Two passes: chunk totals, then each chunk rescanned from the 
+	// combined totals of the chunks before it. result may be first.
+	template <typename RandomIt, 
+							typename OutputIt,
+							typename BinaryOp>
+	OutputIt
+	inclusive_scan(const Parallel_policy& policy, 
+									RandomIt first, 
+									RandomIt last, 
+									OutputIt result, 
+									BinaryOp op)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		const std::size_t chunks = (n + grain - 1) / grain;
+		if (chunks < 2 || lib_impl::Fork_join::slots(chunks) < 2)
+		{
+			// one pass
+			for (std::size_t i = 0; i != n; ++i)
+			{
+				result[i] = (i ? op(result[i - 1], first[i]) : first[i]);
+			}
+			return result + n;
+		}
+		// carry[c] holds the total of the chunks before c
+		std::unique_ptr<std::optional<Value_type>[]> carry(new std::optional<Value_type>[chunks]);
+		auto 
+		total = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = c * grain + grain;
+			Value_type acc = first[c * grain];
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = op(std::move(acc), first[i]);
+			}
+			carry[c + 1].emplace(std::move(acc));
+		};
+		// the last chunk total is not needed
+		lib_impl::Fork_join::run(chunks - 1, total);
+		for (std::size_t c = 2; c < chunks; ++c)
+		{
+			carry[c] = op(*carry[c - 1], std::move(*carry[c]));
+		}
+		auto 
+		scan = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			Value_type acc = (c ? op(*carry[c], first[c * grain]) : Value_type(first[0]));
+			result[c * grain] = acc;
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = op(std::move(acc), first[i]);
+				result[i] = acc;
+			}
+		};
+		lib_impl::Fork_join::run(chunks, scan);
+		return result + n;
+	}
+	template <typename RandomIt, 
+							typename OutputIt>
+	OutputIt
+	inclusive_scan(const Parallel_policy& policy, 
+									RandomIt first, 
+									RandomIt last, 
+									OutputIt result)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib::inclusive_scan(policy, first, last, result, 
+																[](Value_type a, const Value_type& b) -> Value_type { return a + b; });
+	}
 }
 //--- NS lib
 //--- User code
@@ -885,6 +2981,24 @@ helper
     // implicitly generated copy constructor function
     Array_t arr3(arr2);
  		helper::print(arr3.begin(),arr3.end());	
+    // exchange contents
+    arr1.swap(arr3);
+ 		helper::print(arr1.begin(),arr1.end());	
+    // binary image written and read back without per element work
+    if (std::FILE* tmp = std::tmpfile())
+    {
+    	lib::write_binary(fileno(tmp), arr1);
+    	::lseek(fileno(tmp), 0, SEEK_SET);
+    	lib::read_binary(fileno(tmp), arr2);
+    	std::fclose(tmp);
+ 			helper::print(arr2.begin(),arr2.end());	
+    }
+    // chunks of a large Array on the thread pool
+    static lib::Array<double, 1 << 16> arr4;
+    lib::transform(lib::par, arr4.begin(), arr4.end(), arr4.begin(), [](double){ return 0.25; });
+    // same sum for any number of threads
+    std::cout << "arr4 sum: " 
+    					<< lib::reduce(lib::par.deterministic(), arr4.begin(), arr4.end(), 0.0) << '\n';
     		
 		class
 		A
@@ -908,6 +3022,325 @@ helper
     static_cast<void>(test);
 		throw std::runtime_error("Array::use() error");
 	}
+	// Average nanoseconds of f over reps calls
+	template <typename Function>
+	double
+	time_ns(Function f, 
+						int reps)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i != reps; ++i)
+		{
+			f();
+		}
+		auto stop = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(stop - start).count() / reps;
+	}
+	// SIMD kernels against the element loops they replaced
+	void
+	benchmark_simd()
+	{
+		using Tile_t = lib::Array<float, 4096>;
+		static Tile_t a;
+		static Tile_t b;
+		const int reps = 20000;
+		a.fill(1.5f);
+		b.fill(2.5f);
+		std::cout << "Array<float, 4096> " << lib_impl::Simd::isa() << " ns/op\n";
+		// element loops are the previous implementation
+		const double swap_loop = time_ns([]{ lib_impl::swap_ranges(a.begin(), a.end(), b.begin(), 
+																																type::false_type()); }, reps);
+		const double swap_simd = time_ns([]{ a.swap(b); }, reps);
+		std::cout << "swap  loop " << swap_loop << " simd " << swap_simd << '\n';
+		const double fill_loop = time_ns([]{ lib_impl::fill_n(a.begin(), a.size(), 3.5f, 
+																														type::false_type()); }, reps);
+		const double fill_simd = time_ns([]{ a.fill(3.5f); }, reps);
+		std::cout << "fill  loop " << fill_loop << " simd " << fill_simd << '\n';
+		const double copy_loop = time_ns([]{ 
+																			for (std::size_t i = 0; i != a.size(); ++i) 
+																			{
+																				a[i] = b[i];
+																			}
+																		}, reps);
+		// trivially copyable Array is assigned with memcpy
+		const double copy_simd = time_ns([]{ a = b; }, reps);
+		std::cout << "copy  loop " << copy_loop << " simd " << copy_simd << '\n';
+		// results must be kept
+		std::cout << "check " << a[4095] + b[0] << '\n';
+	}
+	//--- Benchmarks
+	// 64 byte element, trivially copyable
+	struct
+	Bench_pod
+	{
+		std::uint64_t v[8];
+	};
+	inline
+	bool
+	operator==(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return std::memcmp(lhs.v, rhs.v, sizeof(lhs.v)) == 0;
+	}
+	inline
+	bool
+	operator!=(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return !(lhs == rhs);
+	}
+	inline
+	bool
+	operator<(const Bench_pod& lhs, 
+						const Bench_pod& rhs)
+	{
+		for (std::size_t i = 0; i != 8; ++i)
+		{
+			if (lhs.v[i] != rhs.v[i])
+			{
+				return lhs.v[i] < rhs.v[i];
+			}
+		}
+		return false;
+	}
+	// Name, i-th value and a key to sum
+	template <typename T>
+	struct
+	Bench_type;
+
+	template <>
+	struct
+	Bench_type<int>
+	{
+		static constexpr const char* name = "int";
+
+		static
+		int
+		make(std::size_t i)
+		{
+			return int(i);
+		}
+		static
+		std::size_t
+		key(int x)
+		{
+			return std::size_t(x);
+		}
+	};
+	template <>
+	struct
+	Bench_type<Bench_pod>
+	{
+		static constexpr const char* name = "pod64";
+
+		static
+		Bench_pod
+		make(std::size_t i)
+		{
+			return Bench_pod{{i, i, i, i, i, i, i, i}};
+		}
+		static
+		std::size_t
+		key(const Bench_pod& x)
+		{
+			return std::size_t(x.v[0]);
+		}
+	};
+	// Past the small string buffer, every element owns a heap block
+	template <>
+	struct
+	Bench_type<std::string>
+	{
+		static constexpr const char* name = "string";
+
+		static
+		std::string
+		make(std::size_t i)
+		{
+			return std::string(24, char('a' + i % 26));
+		}
+		static
+		std::size_t
+		key(const std::string& x)
+		{
+			return std::size_t(x[0]);
+		}
+	};
+	// One measurement: ns per element operation, heap bytes and
+	// allocations per run of ops element operations
+	struct
+	Bench_row
+	{
+		const char* container;
+		const char* type;
+		std::size_t size;
+		const char* op;
+		std::size_t ops;
+		double ns_per_op;
+		double bytes;
+		double allocations;
+	};
+	// Runs f for about 2^22 touched elements after one warm up run
+	template <typename Function>
+	Bench_row
+	bench_run(const char* container, 
+						const char* type, 
+						std::size_t size, 
+						const char* op, 
+						Function f)
+	{
+		const std::size_t reps = (std::size_t(1) << 22) / size + 1;
+		f();
+		const std::uint64_t allocations = lib_impl::Alloc_count::allocations();
+		const std::uint64_t bytes = lib_impl::Alloc_count::bytes();
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i != reps; ++i)
+		{
+			f();
+		}
+		auto stop = std::chrono::steady_clock::now();
+		const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+		return Bench_row{container, type, size, op, size, 
+										ns / double(reps * size), 
+										double(lib_impl::Alloc_count::bytes() - bytes) / double(reps),
+										double(lib_impl::Alloc_count::allocations() - allocations) / double(reps)};
+	}
+	// Rows as a table or as one JSON array
+	class
+	Bench_report
+	{
+		public:
+			explicit
+			Bench_report(bool json)
+				: M_json(json), M_rows(0)
+			{
+				if (M_json)
+				{
+					std::printf("[\n");
+				}
+				else
+				{
+					std::printf("%-12s %-7s %10s %-14s %12s %14s %10s\n", 
+											"container", "type", "size", "op", "ns/op", "bytes/run", "allocs/run");
+				}
+			}
+			~Bench_report()
+			{
+				if (M_json)
+				{
+					std::printf("\n]\n");
+				}
+			}
+			void
+			add(const Bench_row& r)
+			{
+				if (M_json)
+				{
+					std::printf("%s  {\"container\": \"%s\", \"type\": \"%s\", \"size\": %zu, "
+											"\"op\": \"%s\", \"ops_per_run\": %zu, \"ns_per_op\": %.4f, "
+											"\"bytes_per_run\": %.1f, \"allocations_per_run\": %.2f}",
+											(M_rows ? ",\n" : ""), r.container, r.type, r.size, 
+											r.op, r.ops, r.ns_per_op, r.bytes, r.allocations);
+				}
+				else
+				{
+					std::printf("%-12s %-7s %10zu %-14s %12.4f %14.1f %10.2f\n", 
+											r.container, r.type, r.size, r.op, r.ns_per_op, r.bytes, r.allocations);
+				}
+				std::fflush(stdout);
+				++M_rows;
+			}
+		private:
+			bool M_json;
+			std::size_t M_rows;
+	};
+	// Results are kept by storing them here
+	volatile std::size_t bench_sink = 0;
+
+	template <typename Arr>
+	void
+	bench_container(const char* container, 
+										Bench_report& report)
+	{
+		typedef typename Arr::value_type Value_type;
+		typedef Bench_type<Value_type> Type;
+		// too large for the stack
+		static Arr a;
+		static Arr b;
+		const std::size_t n = a.size();
+		for (std::size_t i = 0; i != n; ++i)
+		{
+			a[i] = Type::make(i);
+			b[i] = Type::make(i);
+		}
+		const Value_type val = Type::make(n);
+		report.add(bench_run(container, Type::name, n, "fill",
+													[&]
+													{
+														a.fill(val);
+														bench_sink = Type::key(a[0]);
+													}));
+		// a is b again from here on
+		report.add(bench_run(container, Type::name, n, "copy_assign",
+													[&]
+													{
+														a = b;
+														bench_sink = Type::key(a[0]);
+													}));
+		report.add(bench_run(container, Type::name, n, "swap",
+													[&]
+													{
+														a.swap(b);
+														bench_sink = Type::key(a[0]);
+													}));
+		report.add(bench_run(container, Type::name, n, "iterate",
+													[&]
+													{
+														std::size_t sum = 0;
+														for (const Value_type& x : a)
+														{
+															sum += Type::key(x);
+														}
+														bench_sink = sum;
+													}));
+		report.add(bench_run(container, Type::name, n, "equal",
+													[&]
+													{
+														bench_sink = (a == b);
+													}));
+		report.add(bench_run(container, Type::name, n, "less",
+													[&]
+													{
+														bench_sink = (a < b);
+													}));
+	}
+	template <typename T, 
+							std::size_t n>
+	void
+	bench_type(Bench_report& report)
+	{
+		bench_container<lib::Array<T, n>>("lib::Array", report);
+		bench_container<std::array<T, n>>("std::array", report);
+	}
+	// Every operation on both containers for 16 to 64K elements
+	void
+	benchmark(bool json)
+	{
+		if (!json)
+		{
+			benchmark_simd();
+		}
+		Bench_report report(json);
+		bench_type<int, 16>(report);
+		bench_type<Bench_pod, 16>(report);
+		bench_type<std::string, 16>(report);
+		bench_type<int, 1024>(report);
+		bench_type<Bench_pod, 1024>(report);
+		bench_type<std::string, 1024>(report);
+		bench_type<int, 65536>(report);
+		bench_type<Bench_pod, 65536>(report);
+		bench_type<std::string, 65536>(report);
+	}
 }
 //--- NS helper
 //--- Driver code
@@ -915,18 +3348,20 @@ int
 main(int argc,
 		char* argv[])
 {
-  // MISRA C++ Rule 0–1–11
-  // There shall be no unused named parameters 
-  static_cast<void>(argc);
-  static_cast<void>(argv);
+  if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+  {
+  	helper::benchmark(argc > 2 && std::strcmp(argv[2], "--json") == 0);
+  	return 0;
+  }
 	// Asynchronous task-based concurrency
 	// store exception thrown 
   std::promise<int> prom;
   std::future<int> fut = prom.get_future();
 
-	// thread-based concurrency
-  std::thread 
-  t(
+	// task-based concurrency on a pinned worker of the thread pool
+  std::future<void> 
+  task = 
+  lib_impl::async(
   	[&prom]
 		{
 		  try 
@@ -955,7 +3390,7 @@ main(int argc,
 
   try 
   {
-  	// throws stored exception from thread
+  	// throws stored exception from the task
     std::cout << fut.get();
   } 
   catch(const std::exception& err) 
@@ -966,6 +3401,6 @@ main(int argc,
 	catch (...) 
 	{	
 	}
-	t.join();
+	lib_impl::wait(task);
 	return 0;
 }
\ No newline at end of file
@@ -2,16 +2,85 @@
 
 // Input/Output
 #include <iostream>
+#include <cstdio>
 // Diagnostics
 #include <exception>
+#include <cerrno>
 // General Utilities
 #include <type_traits>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <tuple>
+// Memory
+#include <memory>
+#include <new>
+// Strings
+#include <cstring>
+#include <string>
+// Benchmark baselines
+#include <vector>
+// Memory (malloc_usable_size)
+#include <malloc.h>
+// Memory mapping (mmap, mremap)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
 // Concurrency
 #include <thread>
 #include <future>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+// Time
+#include <chrono>
+// SIMD intrinsics
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // Usage:
 // g++ vector.cpp -o test -lpthread
+// Release build, Vector::operator[] unchecked:
+// g++ -O2 -DNDEBUG vector.cpp -o test -lpthread
+// Allocation trace of the run, .csv or raw binary records:
+// LIB_ALLOC_TRACE_FILE=trace.csv ./test
+// Tracing compiled out, not even counted:
+// g++ -DLIB_ALLOC_TRACE=0 vector.cpp -o test -lpthread
+// Heap use per allocator by name, printed at exit; Allocator, Mmap_allocator
+// and Huge_page_allocator only report with -DLIB_ALLOC_STATS=1:
+// g++ -DLIB_ALLOC_STATS=1 vector.cpp -o test -lpthread && LIB_ALLOC_STATS_DUMP=1 ./test
+// Scalar comparisons only, no SSE2/AVX2 kernels:
+// g++ -DLIB_SIMD=0 vector.cpp -o test -lpthread
+// Vector kept in a file, one element added per run:
+// LIB_MAPPED_FILE=table.bin ./test
+// Vector against std::vector, a table or JSON, at most 64 MiB of heap:
+// g++ -O2 -DNDEBUG vector.cpp -o test -lpthread && ./test --bench
+// LIB_BENCH_MAX_BYTES=67108864 ./test --bench --json > bench.json
+// Parallel algorithms on 3 threads, the caller and 2 pool workers:
+// LIB_THREADS=3 ./test
+
+// Allocation tracing in the global operator new and delete
+#ifndef LIB_ALLOC_TRACE
+#define LIB_ALLOC_TRACE 1
+#endif
+// Statistics of the built-in allocators, shared by every thread;
+// Stats_allocator reports either way
+#ifndef LIB_ALLOC_STATS
+#define LIB_ALLOC_STATS 0
+#endif
+// SSE2/AVX2 comparison kernels, selected at run time
+#ifndef LIB_SIMD
+#define LIB_SIMD 1
+#endif
 
 //--- Implementation details
 namespace
@@ -30,6 +99,537 @@ lib_impl
 				return "Memory Bad Allocation";
 			}
 	};
+	// Allocation tracing
+	enum class
+	Alloc_event
+		: std::uint8_t
+	{
+		new_single,
+		new_array,
+		delete_single,
+		delete_sized,
+		delete_array,
+		delete_array_sized,
+		count
+	};
+	// Binary trace format, one record per event
+	struct
+	Alloc_record
+	{
+		std::uint64_t time_ns;
+		const void* ptr;
+		std::uint64_t size;
+		std::uint32_t thread;
+		Alloc_event event;
+	};
+	// Single producer (the owning thread), single consumer (the flusher)
+	struct
+	Alloc_ring
+	{
+		static constexpr std::size_t capacity = 4096;
+		static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+		std::atomic<bool> in_use{false};
+		std::atomic<std::size_t> head{0};
+		std::atomic<std::size_t> tail{0};
+		std::atomic<std::uint64_t> dropped{0};
+		// Events of the owning thread, written by it alone and read by
+		// any thread, on their own cache line
+		alignas(64) std::atomic<std::uint64_t> counts[static_cast<std::size_t>(Alloc_event::count)]{};
+		std::atomic<std::uint64_t> bytes{0};
+		Alloc_record records[capacity];
+	};
+	enum class
+	Trace_format
+	{
+		binary,
+		csv
+	};
+	// Events are always counted, recorded only between start() and stop().
+	// Recording never allocates: each thread claims a ring from a static
+	// pool and a background thread drains the rings to the trace file.
+	// Each thread counts in its own ring, shared counters only take the
+	// events of threads left without one; reads add them all up.
+	class
+	Alloc_trace
+	{
+		public:
+			static constexpr std::size_t max_threads = 64;
+
+			static
+			void
+			record(Alloc_event e, 
+							void* p, 
+							std::size_t sz)
+			noexcept
+			{
+#if LIB_ALLOC_TRACE
+				const bool is_new = (e == Alloc_event::new_single || e == Alloc_event::new_array);
+				Alloc_ring* ring = M_thread_ring();
+				if (ring)
+				{
+					M_bump(ring->counts[static_cast<std::size_t>(e)], 1);
+					if (is_new)
+					{
+						M_bump(ring->bytes, sz);
+					}
+				}
+				else
+				{
+					M_counts[static_cast<std::size_t>(e)].fetch_add(1, std::memory_order_relaxed);
+					if (is_new)
+					{
+						M_bytes.fetch_add(sz, std::memory_order_relaxed);
+					}
+				}
+				if (!M_enabled.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+				if (!ring)
+				{
+					M_unrecorded.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				const std::size_t h = ring->head.load(std::memory_order_relaxed);
+				if (h - ring->tail.load(std::memory_order_acquire) == Alloc_ring::capacity)
+				{
+					ring->dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				Alloc_record& r = ring->records[h & (Alloc_ring::capacity - 1)];
+				r.time_ns = static_cast<std::uint64_t>(
+											std::chrono::duration_cast<std::chrono::nanoseconds>(
+												std::chrono::steady_clock::now().time_since_epoch()).count());
+				r.ptr = p;
+				r.size = sz;
+				r.thread = static_cast<std::uint32_t>(ring - M_rings);
+				r.event = e;
+				ring->head.store(h + 1, std::memory_order_release);
+#else
+				static_cast<void>(e);
+				static_cast<void>(p);
+				static_cast<void>(sz);
+#endif
+			}
+			// Opens path and starts the flusher, false if already running
+			// or path cannot be opened.
+			static
+			bool
+			start(const char* path, 
+						Trace_format format)
+			{
+				if (M_file)
+				{
+					return false;
+				}
+				M_file = std::fopen(path, (format == Trace_format::csv ? "w" : "wb"));
+				if (!M_file)
+				{
+					return false;
+				}
+				M_format = format;
+				if (format == Trace_format::csv)
+				{
+					std::fputs("time_ns,thread,event,ptr,size\n", M_file);
+				}
+				M_running.store(true, std::memory_order_relaxed);
+				M_flusher = std::thread(&Alloc_trace::M_flush_loop);
+				M_enabled.store(true, std::memory_order_release);
+				return true;
+			}
+			static
+			void
+			stop()
+			{
+				if (!M_file)
+				{
+					return;
+				}
+				M_enabled.store(false, std::memory_order_release);
+				M_running.store(false, std::memory_order_relaxed);
+				M_flusher.join();
+				M_drain();
+				std::fclose(M_file);
+				M_file = 0;
+			}
+			static
+			std::uint64_t
+			count(Alloc_event e)
+			{
+				std::uint64_t n = M_counts[static_cast<std::size_t>(e)].load(std::memory_order_relaxed);
+				for (const Alloc_ring& ring : M_rings)
+				{
+					n += ring.counts[static_cast<std::size_t>(e)].load(std::memory_order_relaxed);
+				}
+				return n;
+			}
+			// Bytes asked for by all new events so far
+			static
+			std::uint64_t
+			bytes()
+			{
+				std::uint64_t n = M_bytes.load(std::memory_order_relaxed);
+				for (const Alloc_ring& ring : M_rings)
+				{
+					n += ring.bytes.load(std::memory_order_relaxed);
+				}
+				return n;
+			}
+			// Events counted but not written to the trace
+			static
+			std::uint64_t
+			dropped()
+			{
+				std::uint64_t n = M_unrecorded.load(std::memory_order_relaxed);
+				for (const Alloc_ring& ring : M_rings)
+				{
+					n += ring.dropped.load(std::memory_order_relaxed);
+				}
+				return n;
+			}
+		private:
+			// Gives the calling thread's ring back to the pool on thread exit,
+			// later events of the thread go to the shared counters
+			struct
+			Ring_guard
+			{
+				Alloc_ring* ring = 0;
+				~Ring_guard()
+				{
+					if (ring)
+					{
+						M_thread_done = true;
+						M_thread_ring_ptr = 0;
+						ring->in_use.store(false, std::memory_order_release);
+					}
+				}
+			};
+
+			// Single writer, a plain load and store instead of a locked add
+			static
+			void
+			M_bump(std::atomic<std::uint64_t>& c, 
+							std::uint64_t n)
+			noexcept
+			{
+				c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			}
+			static
+			Alloc_ring*
+			M_thread_ring()
+			noexcept
+			{
+				if (!M_thread_ring_ptr && !M_thread_done)
+				{
+					for (Alloc_ring& ring : M_rings)
+					{
+						bool expected = false;
+						if (!ring.in_use.load(std::memory_order_relaxed)
+									&& ring.in_use.compare_exchange_strong(expected, true,
+																													std::memory_order_acquire))
+						{
+							M_thread_ring_ptr = &ring;
+							M_guard.ring = &ring;
+							break;
+						}
+					}
+				}
+				return M_thread_ring_ptr;
+			}
+			static
+			void
+			M_flush_loop()
+			{
+				while (M_running.load(std::memory_order_relaxed))
+				{
+					M_drain();
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}
+			static
+			void
+			M_drain()
+			{
+				for (Alloc_ring& ring : M_rings)
+				{
+					std::size_t t = ring.tail.load(std::memory_order_relaxed);
+					const std::size_t h = ring.head.load(std::memory_order_acquire);
+					for (; t != h; ++t)
+					{
+						M_write(ring.records[t & (Alloc_ring::capacity - 1)]);
+					}
+					ring.tail.store(t, std::memory_order_release);
+				}
+				std::fflush(M_file);
+			}
+			static
+			void
+			M_write(const Alloc_record& r)
+			{
+				if (M_format == Trace_format::csv)
+				{
+					std::fprintf(M_file, "%llu,%u,%u,%p,%llu\n",
+												static_cast<unsigned long long>(r.time_ns),
+												static_cast<unsigned>(r.thread),
+												static_cast<unsigned>(r.event),
+												r.ptr,
+												static_cast<unsigned long long>(r.size));
+				}
+				else
+				{
+					std::fwrite(&r, sizeof(r), 1, M_file);
+				}
+			}
+
+			// Constant initialized, usable before any dynamic initialization
+			static std::atomic<std::uint64_t> M_counts[static_cast<std::size_t>(Alloc_event::count)];
+			static std::atomic<std::uint64_t> M_bytes;
+			static std::atomic<std::uint64_t> M_unrecorded;
+			static std::atomic<bool> M_enabled;
+			static std::atomic<bool> M_running;
+			static Alloc_ring M_rings[max_threads];
+			static std::FILE* M_file;
+			static Trace_format M_format;
+			static std::thread M_flusher;
+			static thread_local Alloc_ring* M_thread_ring_ptr;
+			static thread_local bool M_thread_done;
+			static thread_local Ring_guard M_guard;
+	};
+	std::atomic<std::uint64_t> Alloc_trace::M_counts[static_cast<std::size_t>(Alloc_event::count)]{};
+	std::atomic<std::uint64_t> Alloc_trace::M_bytes{0};
+	std::atomic<std::uint64_t> Alloc_trace::M_unrecorded{0};
+	std::atomic<bool> Alloc_trace::M_enabled{false};
+	std::atomic<bool> Alloc_trace::M_running{false};
+	Alloc_ring Alloc_trace::M_rings[Alloc_trace::max_threads]{};
+	std::FILE* Alloc_trace::M_file = 0;
+	Trace_format Alloc_trace::M_format = Trace_format::binary;
+	std::thread Alloc_trace::M_flusher{};
+	thread_local Alloc_ring* Alloc_trace::M_thread_ring_ptr = 0;
+	thread_local bool Alloc_trace::M_thread_done = false;
+	thread_local Alloc_trace::Ring_guard Alloc_trace::M_guard{};
+
+	class
+	Alloc_stats;
+	// Process-wide list of named allocator statistics
+	class
+	Alloc_registry
+	{
+		public:
+			static
+			void
+			add(Alloc_stats* s);
+			static
+			void
+			remove(Alloc_stats* s);
+			// First statistics registered as name, null if none
+			static
+			Alloc_stats*
+			find(const char* name);
+			static
+			void
+			dump(std::FILE* out);
+		private:
+			// Constant initialized, usable before any dynamic initialization
+			static std::mutex M_lock;
+			static Alloc_stats* M_head;
+	};
+	std::mutex Alloc_registry::M_lock;
+	Alloc_stats* Alloc_registry::M_head = 0;
+	// Heap use of the containers reporting to it: bytes in use and at
+	// most, blocks by size, growth by moving to a new block and growth
+	// in place. Registered under its name while it exists.
+	class
+	Alloc_stats
+	{
+		public:
+			// Sizes by powers of two, bucket b holds [2^b, 2^(b+1)) bytes
+			static constexpr std::size_t buckets = 64;
+
+			explicit
+			Alloc_stats(const char* name)
+				: M_name(name)
+			{
+				Alloc_registry::add(this);
+			}
+			Alloc_stats(const Alloc_stats&) = delete;
+			Alloc_stats&
+			operator=(const Alloc_stats&) = delete;
+			~Alloc_stats()
+			{
+				Alloc_registry::remove(this);
+			}
+			void
+			allocated(std::size_t bytes)
+			noexcept
+			{
+				M_allocations.fetch_add(1, std::memory_order_relaxed);
+				M_histogram[M_bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+				M_add_live(std::int64_t(bytes));
+			}
+			void
+			deallocated(std::size_t bytes)
+			noexcept
+			{
+				M_deallocations.fetch_add(1, std::memory_order_relaxed);
+				M_live.fetch_sub(std::int64_t(bytes), std::memory_order_relaxed);
+			}
+			// Storage replaced by a larger block, reported with its
+			// allocation and deallocation
+			void
+			grown()
+			noexcept
+			{
+				M_growths.fetch_add(1, std::memory_order_relaxed);
+			}
+			// Storage grown without moving the elements
+			void
+			reallocated(std::size_t old_bytes, 
+									std::size_t new_bytes)
+			noexcept
+			{
+				M_reallocations.fetch_add(1, std::memory_order_relaxed);
+				M_add_live(std::int64_t(new_bytes) - std::int64_t(old_bytes));
+			}
+			const char*
+			name() const
+			{
+				return M_name;
+			}
+			// Negative after freeing adopted storage never reported
+			std::int64_t
+			live_bytes() const
+			{
+				return M_live.load(std::memory_order_relaxed);
+			}
+			std::int64_t
+			peak_bytes() const
+			{
+				return M_peak.load(std::memory_order_relaxed);
+			}
+			std::uint64_t
+			allocations() const
+			{
+				return M_allocations.load(std::memory_order_relaxed);
+			}
+			std::uint64_t
+			deallocations() const
+			{
+				return M_deallocations.load(std::memory_order_relaxed);
+			}
+			std::uint64_t
+			growths() const
+			{
+				return M_growths.load(std::memory_order_relaxed);
+			}
+			std::uint64_t
+			reallocations() const
+			{
+				return M_reallocations.load(std::memory_order_relaxed);
+			}
+			std::uint64_t
+			histogram(std::size_t bucket) const
+			{
+				return M_histogram[bucket].load(std::memory_order_relaxed);
+			}
+			void
+			dump(std::FILE* out) const
+			{
+				std::fprintf(out, "%s: live %lld B, peak %lld B, %llu allocations, "
+													"%llu deallocations, %llu growths, %llu in place\n",
+											M_name,
+											static_cast<long long>(live_bytes()),
+											static_cast<long long>(peak_bytes()),
+											static_cast<unsigned long long>(allocations()),
+											static_cast<unsigned long long>(deallocations()),
+											static_cast<unsigned long long>(growths()),
+											static_cast<unsigned long long>(reallocations()));
+				for (std::size_t b = 0; b != buckets; ++b)
+				{
+					if (const std::uint64_t n = histogram(b))
+					{
+						std::fprintf(out, "  %llu B: %llu\n", 
+													static_cast<unsigned long long>(std::uint64_t(1) << b),
+													static_cast<unsigned long long>(n));
+					}
+				}
+			}
+		private:
+			friend class Alloc_registry;
+
+			static
+			std::size_t
+			M_bucket(std::size_t bytes)
+			{
+				return (bytes ? std::size_t(63 - __builtin_clzll(bytes)) : 0);
+			}
+			void
+			M_add_live(std::int64_t bytes)
+			{
+				const std::int64_t live = M_live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				std::int64_t peak = M_peak.load(std::memory_order_relaxed);
+				while (live > peak 
+								&& !M_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+				{
+				}
+			}
+
+			const char* M_name;
+			Alloc_stats* M_next{0};
+			std::atomic<std::int64_t> M_live{0};
+			std::atomic<std::int64_t> M_peak{0};
+			std::atomic<std::uint64_t> M_allocations{0};
+			std::atomic<std::uint64_t> M_deallocations{0};
+			std::atomic<std::uint64_t> M_growths{0};
+			std::atomic<std::uint64_t> M_reallocations{0};
+			std::atomic<std::uint64_t> M_histogram[buckets]{};
+	};
+	inline
+	void
+	Alloc_registry::add(Alloc_stats* s)
+	{
+		std::lock_guard<std::mutex> lock(M_lock);
+		s->M_next = M_head;
+		M_head = s;
+	}
+	inline
+	void
+	Alloc_registry::remove(Alloc_stats* s)
+	{
+		std::lock_guard<std::mutex> lock(M_lock);
+		for (Alloc_stats** p = &M_head; *p; p = &(*p)->M_next)
+		{
+			if (*p == s)
+			{
+				*p = s->M_next;
+				break;
+			}
+		}
+	}
+	inline
+	Alloc_stats*
+	Alloc_registry::find(const char* name)
+	{
+		std::lock_guard<std::mutex> lock(M_lock);
+		for (Alloc_stats* s = M_head; s; s = s->M_next)
+		{
+			if (std::strcmp(s->M_name, name) == 0)
+			{
+				return s;
+			}
+		}
+		return 0;
+	}
+	inline
+	void
+	Alloc_registry::dump(std::FILE* out)
+	{
+		std::lock_guard<std::mutex> lock(M_lock);
+		for (Alloc_stats* s = M_head; s; s = s->M_next)
+		{
+			s->dump(out);
+		}
+	}
 }
 //--- NS lib_impl
 
@@ -44,75 +644,173 @@ lib_impl
 // Rule 16–0–2
 // Macros shall only be #define’d or #undef’d in the global namespace.
 #define _IsUnused __attribute__ ((__unused__))
+#define _Target_sse2 __attribute__ ((__target__ ("sse2")))
+#define _Target_avx2 __attribute__ ((__target__ ("avx2")))
+#define _Target_sse42 __attribute__ ((__target__ ("sse4.2")))
+// Keeps the replacements below out of their callers, so GCC does not
+// pair a new-expression with the std::free inside operator delete
+#define _Noinline __attribute__ ((__noinline__))
 
 // The program is ill-formed if a replacement is defined in namespace other than global namespace,
 // or if it is defined as a static non-member function at global scope. 
 // no inline, required by [replacement.functions]
+_Noinline
 void* 
 operator 
 new(std::size_t sz)
 {
-	std::printf("1) new(size_t), size = %zu\n", sz);
   // avoid std::malloc(0) which may return nullptr on success
   if (sz == 0)
       ++sz; 
 
-  if (void *ptr = std::malloc(sz))
+  void* ptr = std::malloc(sz);
+  if (ptr)
+  {
+      lib_impl::Alloc_trace::record(lib_impl::Alloc_event::new_single, ptr, sz);
       return ptr;
+  }
 	// required by [new.delete.single]
   throw lib_impl::BadAlloc{}; 
 }
  
 // no inline, required by [replacement.functions]
+_Noinline
 void* 
 operator 
 new[](std::size_t sz)
 {
-	std::printf("2) new[](size_t), size = %zu\n", sz);
   if (sz == 0)
       ++sz; 
 
-  if (void *ptr = std::malloc(sz))
+  void* ptr = std::malloc(sz);
+  if (ptr)
+  {
+      lib_impl::Alloc_trace::record(lib_impl::Alloc_event::new_array, ptr, sz);
       return ptr;
+  }
 
   throw lib_impl::BadAlloc{}; 
 }
  
+_Noinline
 void 
 operator 
 delete(void* ptr) 
 noexcept
 {
-    std::puts("3) delete(void*)");
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_single, ptr, 0);
     std::free(ptr);
 }
  
+_Noinline
 void 
 operator 
 delete(void* ptr, 
 			std::size_t size) 
 noexcept
 {
-    std::printf("4) delete(void*, size_t), size = %zu\n", size);
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_sized, ptr, size);
     std::free(ptr);
 }
  
+_Noinline
 void 
 operator 
 delete[](void* ptr) 
 noexcept
 {
-    std::puts("5) delete[](void* ptr)");
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_array, ptr, 0);
     std::free(ptr);
 }
  
+_Noinline
 void 
 operator 
 delete[](void* ptr, 
 				std::size_t size) 
 noexcept
 {
-    std::printf("6) delete[](void*, size_t), size = %zu\n", size);
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_array_sized, ptr, size);
+    std::free(ptr);
+}
+// Over-aligned types, new-expressions pass alignof(T) above
+// __STDCPP_DEFAULT_NEW_ALIGNMENT__. Same heap and trace as above.
+_Noinline
+void* 
+operator 
+new(std::size_t sz, 
+		std::align_val_t al)
+{
+  const std::size_t align = static_cast<std::size_t>(al);
+  // aligned_alloc takes whole multiples of the alignment
+  void* ptr = std::aligned_alloc(align, (sz + align - 1) / align * align + (sz == 0 ? align : 0));
+  if (ptr)
+  {
+      lib_impl::Alloc_trace::record(lib_impl::Alloc_event::new_single, ptr, sz);
+      return ptr;
+  }
+  throw lib_impl::BadAlloc{}; 
+}
+
+_Noinline
+void* 
+operator 
+new[](std::size_t sz, 
+			std::align_val_t al)
+{
+  const std::size_t align = static_cast<std::size_t>(al);
+  void* ptr = std::aligned_alloc(align, (sz + align - 1) / align * align + (sz == 0 ? align : 0));
+  if (ptr)
+  {
+      lib_impl::Alloc_trace::record(lib_impl::Alloc_event::new_array, ptr, sz);
+      return ptr;
+  }
+  throw lib_impl::BadAlloc{}; 
+}
+
+_Noinline
+void 
+operator 
+delete(void* ptr, 
+			std::align_val_t) 
+noexcept
+{
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_single, ptr, 0);
+    std::free(ptr);
+}
+
+_Noinline
+void 
+operator 
+delete(void* ptr, 
+			std::size_t size, 
+			std::align_val_t) 
+noexcept
+{
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_sized, ptr, size);
+    std::free(ptr);
+}
+
+_Noinline
+void 
+operator 
+delete[](void* ptr, 
+				std::align_val_t) 
+noexcept
+{
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_array, ptr, 0);
+    std::free(ptr);
+}
+
+_Noinline
+void 
+operator 
+delete[](void* ptr, 
+				std::size_t size, 
+				std::align_val_t) 
+noexcept
+{
+    lib_impl::Alloc_trace::record(lib_impl::Alloc_event::delete_array_sized, ptr, size);
     std::free(ptr);
 }
 //---End Global Namespace
@@ -126,6 +824,8 @@ type
 	struct forward_iterator_tag : public input_iterator_tag { };
 	struct bidirectional_iterator_tag : public forward_iterator_tag { };
 	struct random_access_iterator_tag : public bidirectional_iterator_tag { };
+	// Elements at consecutive addresses: &*(it + n) == &*it + n
+	struct contiguous_iterator_tag : public random_access_iterator_tag { };
 		
 	template <typename Iterator>
 	struct 
@@ -141,7 +841,7 @@ type
 	struct 
 	Iterator_traits<T*>	
 	{
-		typedef random_access_iterator_tag					 iterator_category;
+		typedef contiguous_iterator_tag							 iterator_category;
 		typedef T															       value_type;
 		typedef std::ptrdiff_t										   difference_type;
 		typedef T*												           pointer;
@@ -151,7 +851,7 @@ type
 	struct 
 	Iterator_traits<const T*>	
 	{
-		typedef random_access_iterator_tag					 iterator_category;
+		typedef contiguous_iterator_tag							 iterator_category;
 		typedef T															       value_type;
 		typedef std::ptrdiff_t										   difference_type;
 		typedef const T*									           pointer;
@@ -433,10 +1133,25 @@ type
 		T __j;
 		typename type::Iterator_traits<T>::difference_type __n;
 	};  
-	// Container Concepts
-	template <class Container>
+	template <class T>
 	struct 
-	ContainerConcept
+	ContiguousIteratorConcept
+	{
+		void __constraints() 
+		{
+			__function_requires< RandomAccessIteratorConcept<T> >();
+			__function_requires< ConvertibleConcept<
+																			        typename type::Iterator_traits<T>::iterator_category,
+																			        type::contiguous_iterator_tag> >();
+			// requires the element address as a pointer
+			typename type::Iterator_traits<T>::pointer __p _IsUnused = std::addressof(*__i);
+		}
+		T __i;
+	};  
+	// Container Concepts
+	template <class Container>
+	struct 
+	ContainerConcept
 	{
 		typedef typename Container::value_type Value_type;
 		typedef typename Container::difference_type Difference_type;
@@ -679,6 +1394,112 @@ type
     : public true_type
     { 
     }; 
+	// Type properties
+  /// is_trivially_relocatable
+  // Moving an object to new storage and ending the lifetime of the source
+  // is equivalent to copying its bytes.
+  // Specialize for types which hold no pointer into themselves.
+  template<typename _Tp>
+    struct is_trivially_relocatable
+    : public __bool_constant<std::is_trivially_copyable<_Tp>::value
+                              && std::is_trivially_destructible<_Tp>::value>
+    {
+    };
+  /// is_contiguous_iterator
+  template<typename _Iter>
+    struct is_contiguous_iterator
+    : public __bool_constant<std::is_convertible<
+                              typename Iterator_traits<_Iter>::iterator_category,
+                              contiguous_iterator_tag>::value>
+    {
+    };
+  // Allocator extensions
+  /// has_allocate_at_least
+  template<typename _Alloc, typename = __void_t<>>
+    struct has_allocate_at_least
+    : public false_type
+    {
+    };
+  template<typename _Alloc>
+    struct has_allocate_at_least<_Alloc,
+                                  __void_t<decltype(std::declval<_Alloc&>()
+                                                      .allocate_at_least(std::size_t()))>>
+    : public true_type
+    {
+    };
+  /// has_good_size
+  template<typename _Alloc, typename = __void_t<>>
+    struct has_good_size
+    : public false_type
+    {
+    };
+  template<typename _Alloc>
+    struct has_good_size<_Alloc,
+                          __void_t<decltype(std::declval<const _Alloc&>()
+                                              .good_size(std::size_t()))>>
+    : public true_type
+    {
+    };
+  /// has_reallocate
+  template<typename _Alloc, typename = __void_t<>>
+    struct has_reallocate
+    : public false_type
+    {
+    };
+  template<typename _Alloc>
+    struct has_reallocate<_Alloc,
+                           __void_t<decltype(std::declval<_Alloc&>()
+                                               .reallocate_at_least(std::declval<typename _Alloc::pointer>(),
+                                                                     std::size_t(),
+                                                                     std::size_t()))>>
+    : public true_type
+    {
+    };
+  /// has_allocate_zeroed
+  template<typename _Alloc, typename = __void_t<>>
+    struct has_allocate_zeroed
+    : public false_type
+    {
+    };
+  template<typename _Alloc>
+    struct has_allocate_zeroed<_Alloc,
+                                __void_t<decltype(std::declval<_Alloc&>()
+                                                    .allocate_zeroed(std::size_t()))>>
+    : public true_type
+    {
+    };
+  /// has_alloc_stats
+  template<typename _Alloc, typename = __void_t<>>
+    struct has_alloc_stats
+    : public false_type
+    {
+    };
+  template<typename _Alloc>
+    struct has_alloc_stats<_Alloc,
+                            __void_t<decltype(std::declval<const _Alloc&>().stats())>>
+    : public true_type
+    {
+    };
+  /// is_over_aligned
+  // Stricter than the global operator new without an alignment argument
+  template<typename _Tp>
+    struct is_over_aligned
+    : public __bool_constant<(alignof(_Tp) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)>
+    {
+    };
+  /// alloc_alignment
+  // Alignment of every block an allocator hands out, its alignment
+  // member or else alignof(value_type)
+  template<typename _Alloc, typename = __void_t<>>
+    struct alloc_alignment
+    : public integral_constant<std::size_t, alignof(typename _Alloc::value_type)>
+    {
+    };
+  template<typename _Alloc>
+    struct alloc_alignment<_Alloc, __void_t<decltype(_Alloc::alignment)>>
+    : public integral_constant<std::size_t, _Alloc::alignment>
+    {
+    };
 }
 //---NS type
 //--- Implementation details
@@ -795,6 +1616,242 @@ lib_impl
 		return ls.end(); 
 	}
 	//---	
+	// Usable bytes of a malloc request of sz bytes.
+	// glibc chunks carry one size word and are 16 byte aligned,
+	// requests above the mmap threshold are rounded to pages.
+	constexpr
+	std::size_t
+	malloc_good_size(std::size_t sz)
+	{
+		constexpr std::size_t size_sz = sizeof(std::size_t);
+		constexpr std::size_t align_mask = 2 * size_sz - 1;
+		constexpr std::size_t min_chunk = 4 * size_sz;
+		constexpr std::size_t mmap_threshold = 128 * 1024;
+		constexpr std::size_t page = 4096;
+		if (sz >= mmap_threshold)
+		{
+			return ((sz + 2 * size_sz + page - 1) & ~(page - 1)) - 2 * size_sz;
+		}
+		const std::size_t chunk = (sz + size_sz + align_mask) & ~align_mask;
+		return (chunk < min_chunk ? min_chunk : chunk) - size_sz;
+	}
+	//---	
+	// Allocator traits
+	// Propagation and equality of an allocator as type::true_type or
+	// type::false_type, defaults as for std::allocator_traits.
+	template <typename A, 
+							typename = type::__void_t<>>
+	struct
+	Alloc_pocca
+		: public type::false_type
+	{
+	};
+	template <typename A>
+	struct
+	Alloc_pocca<A, type::__void_t<typename A::propagate_on_container_copy_assignment>>
+		: public type::__bool_constant<bool(typename A::propagate_on_container_copy_assignment{})>
+	{
+	};
+	template <typename A, 
+							typename = type::__void_t<>>
+	struct
+	Alloc_pocma
+		: public type::false_type
+	{
+	};
+	template <typename A>
+	struct
+	Alloc_pocma<A, type::__void_t<typename A::propagate_on_container_move_assignment>>
+		: public type::__bool_constant<bool(typename A::propagate_on_container_move_assignment{})>
+	{
+	};
+	template <typename A, 
+							typename = type::__void_t<>>
+	struct
+	Alloc_pocs
+		: public type::false_type
+	{
+	};
+	template <typename A>
+	struct
+	Alloc_pocs<A, type::__void_t<typename A::propagate_on_container_swap>>
+		: public type::__bool_constant<bool(typename A::propagate_on_container_swap{})>
+	{
+	};
+	template <typename A, 
+							typename = type::__void_t<>>
+	struct
+	Alloc_always_equal
+		: public type::__bool_constant<std::is_empty<A>::value>
+	{
+	};
+	template <typename A>
+	struct
+	Alloc_always_equal<A, type::__void_t<typename A::is_always_equal>>
+		: public type::__bool_constant<bool(typename A::is_always_equal{})>
+	{
+	};
+	template <typename A>
+	struct
+	Alloc_traits
+	{
+		typedef Alloc_pocca<A>										propagate_on_container_copy_assignment;
+		typedef Alloc_pocma<A>										propagate_on_container_move_assignment;
+		typedef Alloc_pocs<A>											propagate_on_container_swap;
+		typedef Alloc_always_equal<A>							is_always_equal;
+
+		// Allocator for a copy of a container using a
+		static
+		A
+		select_on_container_copy_construction(const A& a)
+		{
+			return M_select(a, 0);
+		}
+		private:
+			template <typename A2>
+			static
+			auto
+			M_select(const A2& a, 
+								int)
+			-> decltype(a.select_on_container_copy_construction())
+			{
+				return a.select_on_container_copy_construction();
+			}
+			template <typename A2>
+			static
+			A2
+			M_select(const A2& a, 
+								long)
+			{
+				return a;
+			}
+	};
+	//---	
+	// Storage for n T from the global operator new, through the aligned
+	// overloads when T is over-aligned.
+	template <class T>
+	inline
+	T*
+	new_storage(std::size_t n, 
+							type::false_type)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	template <class T>
+	inline
+	T*
+	new_storage(std::size_t n, 
+							type::true_type)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+	}
+	template <class T>
+	inline
+	T*
+	new_storage(std::size_t n)
+	{
+		return new_storage<T>(n, type::is_over_aligned<T>());
+	}
+	template <class T>
+	inline
+	void
+	delete_storage(T* p, 
+									std::size_t n, 
+									type::false_type)
+	{
+		::operator delete(p, n * sizeof(T));
+	}
+	template <class T>
+	inline
+	void
+	delete_storage(T* p, 
+									std::size_t n, 
+									type::true_type)
+	{
+		::operator delete(p, n * sizeof(T), std::align_val_t(alignof(T)));
+	}
+	template <class T>
+	inline
+	void
+	delete_storage(T* p, 
+									std::size_t n)
+	{
+		delete_storage<T>(p, n, type::is_over_aligned<T>());
+	}
+	//---	
+	// Allocator statistics
+	// The hook is a stats() member returning the Alloc_stats to report to,
+	// or null. Without the hook nothing is reported.
+	template <class A>
+	inline
+	Alloc_stats*
+	alloc_stats(const A& a, 
+							type::true_type)
+	{
+		return a.stats();
+	}
+	template <class A>
+	inline
+	Alloc_stats*
+	alloc_stats(const A&, 
+							type::false_type)
+	{
+		return 0;
+	}
+	template <class A>
+	inline
+	Alloc_stats*
+	alloc_stats(const A& a)
+	{
+		return alloc_stats(a, type::has_alloc_stats<A>());
+	}
+	// Statistics shared by every instance of an allocator template, 
+	// null unless LIB_ALLOC_STATS.
+	// Never destroyed, containers may free memory during static destruction.
+	inline
+	Alloc_stats*
+	make_shared_stats(const char* name, 
+										void* storage)
+	{
+		return ::new(storage) Alloc_stats(name);
+	}
+	inline
+	Alloc_stats*
+	allocator_stats()
+	{
+#if LIB_ALLOC_STATS
+		alignas(Alloc_stats) static unsigned char storage[sizeof(Alloc_stats)];
+		static Alloc_stats* const stats = make_shared_stats("Allocator", storage);
+		return stats;
+#else
+		return 0;
+#endif
+	}
+	inline
+	Alloc_stats*
+	mmap_allocator_stats()
+	{
+#if LIB_ALLOC_STATS
+		alignas(Alloc_stats) static unsigned char storage[sizeof(Alloc_stats)];
+		static Alloc_stats* const stats = make_shared_stats("Mmap_allocator", storage);
+		return stats;
+#else
+		return 0;
+#endif
+	}
+	inline
+	Alloc_stats*
+	huge_page_allocator_stats()
+	{
+#if LIB_ALLOC_STATS
+		alignas(Alloc_stats) static unsigned char storage[sizeof(Alloc_stats)];
+		static Alloc_stats* const stats = make_shared_stats("Huge_page_allocator", storage);
+		return stats;
+#else
+		return 0;
+#endif
+	}
+	//---	
 	// Allocator
 	template <class T>
 	class
@@ -808,6 +1865,13 @@ lib_impl
 		  using const_pointer                          = const T*;
 		  using reference                      	 			 = T&;    		  		  
 		  using const_reference                      	 = const T&;    
+		  // Stateless, any instance frees memory of any other
+		  using propagate_on_container_move_assignment = type::true_type;
+		  using is_always_equal                        = type::true_type;
+		  // malloc alignment, alignof(T) for over-aligned T
+		  static constexpr std::size_t alignment 
+		  	= (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? alignof(T) 
+		  																						: __STDCPP_DEFAULT_NEW_ALIGNMENT__);
 
 			template <class T2>
 			struct
@@ -849,15 +1913,16 @@ lib_impl
 		  allocate(const size_type n)
 		  {
 		  	// Calls class-specific overload of new
-		  	return reinterpret_cast<pointer>( operator new( n * sizeof(value_type) ) );
+		  	return M_allocate(n, type::is_over_aligned<value_type>());
 		  }
 
+		  // Unsized: n may be the larger count allocate_at_least or
+		  // reallocate_at_least reported, not the size operator new was given
 		  constexpr 
 		  void 
-		  deallocate(pointer p, const size_type n)
+		  deallocate(pointer p, const size_type)
 		  {
-		  	::operator delete(p,n);
-		  	
+		  	M_deallocate(p, type::is_over_aligned<value_type>());
 		  }
 			void 
 			construct( pointer p, 
@@ -889,11 +1954,146 @@ lib_impl
 		  {
 		      return ::operator new[](cnt);
 		  } 
+		  static void* operator new(size_type cnt, std::align_val_t al)
+		  {
+		      return ::operator new(cnt, al);
+		  }
 		  size_type
 		  max_size() const
 		  {
 		  	return std::size_t(-1) / sizeof(T);
 		  }		  
+		  // Allocation extensions
+		  struct
+		  Allocation_result
+		  {
+		  	pointer ptr;
+		  	size_type count;
+		  };
+		  // Storage for at least n elements, count reports what was
+		  // really handed out by malloc behind the global operator new.
+		  [[nodiscard]]
+		  Allocation_result
+		  allocate_at_least(const size_type n)
+		  {
+		  	pointer p = allocate(n);
+		  	return Allocation_result{p, ::malloc_usable_size(p) / sizeof(value_type)};
+		  }
+		  // Elements a request for n elements really provides.
+		  size_type
+		  good_size(const size_type n) const
+		  {
+		  	return malloc_good_size(n * sizeof(value_type)) / sizeof(value_type);
+		  }
+		  // Blocks below this size are not worth growing in place.
+		  static constexpr size_type reallocate_threshold = 1024 * 1024;
+		  // Grows the block at p, holding n elements, to at least new_n
+		  // elements and keeps its bytes; ptr is null when declined and p
+		  // is then left untouched.
+		  // The replaced global operator new is malloc, so its blocks can
+		  // be handed to realloc. Large glibc blocks are mmap'ed and
+		  // realloc remaps their pages instead of copying them.
+		  // Out of line, once inlined GCC moves the caller's size
+		  // arithmetic on p below the realloc and warns of a use after free.
+		  [[nodiscard]]
+		  _Noinline
+		  Allocation_result
+		  reallocate_at_least(pointer p, 
+		  										const size_type n, 
+		  										const size_type new_n)
+		  {
+		  	// realloc keeps only malloc alignment
+		  	if (n * sizeof(value_type) < reallocate_threshold
+		  				|| bool(type::is_over_aligned<value_type>())
+		  				|| new_n > max_size())
+		  	{
+		  		return Allocation_result{0, 0};
+		  	}
+		  	// p is only an address for the trace once realloc has run
+		  	const std::uintptr_t old = reinterpret_cast<std::uintptr_t>(p);
+		  	void* q = std::realloc(p, new_n * sizeof(value_type));
+		  	if (!q)
+		  	{
+		  		return Allocation_result{0, 0};
+		  	}
+		  	M_trace_moved(old, q, new_n * sizeof(value_type));
+		  	return Allocation_result{static_cast<pointer>(q), 
+		  														::malloc_usable_size(q) / sizeof(value_type)};
+		  }
+		  // Storage for n elements with all bytes zero.
+		  // calloc knows when memory is fresh from the kernel, large
+		  // blocks then map zero pages lazily instead of being cleared.
+		  // Same heap as the replaced global operator new, deallocate frees it.
+		  [[nodiscard]]
+		  pointer
+		  allocate_zeroed(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	if (bool(type::is_over_aligned<value_type>()))
+		  	{
+		  		pointer q = allocate(n ? n : 1);
+		  		std::memset(static_cast<void*>(q), 0, n * sizeof(value_type));
+		  		return q;
+		  	}
+		  	const size_type count = (n ? n : 1);
+		  	void* p = std::calloc(count, sizeof(value_type));
+		  	if (!p)
+		  		throw BadAlloc{};
+		  	Alloc_trace::record(Alloc_event::new_single, p, count * sizeof(value_type));
+		  	return static_cast<pointer>(p);
+		  }
+		  // Every container on Allocator reports to one entry, 
+		  // when built with LIB_ALLOC_STATS
+		  static
+		  Alloc_stats*
+		  stats()
+		  {
+		  	return allocator_stats();
+		  }
+		private:
+		  pointer
+		  M_allocate(const size_type n, 
+		  						type::false_type)
+		  {
+		  	return reinterpret_cast<pointer>( operator new( n * sizeof(value_type) ) );
+		  }
+		  // A block realloc moved is traced as a delete and a new.
+		  // Out of line, GCC would otherwise flag the old address as
+		  // a use after realloc.
+		  static
+		  _Noinline
+		  void
+		  M_trace_moved(std::uintptr_t from, 
+		  							void* to, 
+		  							std::size_t bytes)
+		  noexcept
+		  {
+		  	if (reinterpret_cast<std::uintptr_t>(to) != from)
+		  	{
+		  		Alloc_trace::record(Alloc_event::delete_single, reinterpret_cast<void*>(from), 0);
+		  		Alloc_trace::record(Alloc_event::new_single, to, bytes);
+		  	}
+		  }
+		  pointer
+		  M_allocate(const size_type n, 
+		  						type::true_type)
+		  {
+		  	return reinterpret_cast<pointer>( operator new( n * sizeof(value_type), 
+		  																								std::align_val_t(alignof(value_type)) ) );
+		  }
+		  void
+		  M_deallocate(pointer p, 
+		  							type::false_type)
+		  {
+		  	::operator delete(p);
+		  }
+		  void
+		  M_deallocate(pointer p, 
+		  							type::true_type)
+		  {
+		  	::operator delete(p, std::align_val_t(alignof(value_type)));
+		  }
 	};
 	template <class T>
 	inline
@@ -930,1651 +2130,7303 @@ lib_impl
 				typedef Allocator<T2> other; 
 			};	
 	};
-	
 	//---	
-	
-	// Normal iterator	
-	template <typename Iter,
-						typename Container>
+	// Mmap allocator
+	// Whole pages of anonymous memory, grown in place with mremap.
+	// Meant for large buffers, every allocation takes at least a page.
+	template <class T>
 	class
-	Normal_iterator
+	Mmap_allocator
 	{
-			typedef type::Iterator_traits<Iter>       Traits_type;
-			template <typename It>
-			using container_type_enable_if					= typename std::enable_if<(std::is_same<It,
-																									typename Container::pointer>::value),
-																									Container>::type;	
 		public:
-			using iterator_type											= Iter;		
-			using iterator_category									= typename Traits_type::iterator_category;
-			using value_type												= typename Traits_type::value_type;
-			using difference_type										= typename Traits_type::difference_type;
-			using reference													= typename Traits_type::reference;
-			using pointer														= typename Traits_type::pointer;	
-			
-			Normal_iterator()
-        : M_curr()
-      {
-      }
-      constexpr
-			Normal_iterator(const iterator_type& it) 
-				: M_curr(it) 
-			{ 
-			}
-			// Allow iterator to const_iterator conversion
-			template <typename I>
-			Normal_iterator(const Normal_iterator<I, container_type_enable_if<I>>& it)
-				: M_curr(it.base()) 
-			{ 
-			}
-			// Forward iterator requirements
-			reference
-			operator*() const
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+
+		  using propagate_on_container_move_assignment = type::true_type;
+		  using is_always_equal                        = type::true_type;
+
+		  // Whole pages
+		  static constexpr std::size_t alignment = 4096;
+
+			template <class T2>
+			struct
+			rebind
 			{
-				return *M_curr;
-			}
-			pointer
-			operator->() const
+				typedef Mmap_allocator<T2> other; 
+			};
+			struct
+			Allocation_result
 			{
-				return &(operator*());
-			}																			
-			Normal_iterator&
-			operator++()
-			{ 
-				++M_curr;
-				return *this;
-			}
-			Normal_iterator
-			operator++(int)
-			{ 
-				return Normal_iterator(M_curr++);
-			}	
-			// Bidirectional iterator requirements		
-			Normal_iterator&
-			operator--()
-			{ 
-				--M_curr;
-				return *this;
-			}
-			Normal_iterator
-			operator--(int)
-			{ 
-				return Normal_iterator(M_curr--);
-			}	
-			// Random access iterator requirements
-			reference
-			operator[](const difference_type& n) const	
-			{
-				return M_curr[n];
-			}	
-			Normal_iterator&
-			operator+=(const difference_type& n)	
-			{
-				M_curr += n; 
-				return *this;
-			}	
-			Normal_iterator
-			operator+(const difference_type& n)	const
+				pointer ptr;
+				size_type count;
+			};
+
+		  constexpr 
+		  Mmap_allocator() 
+		  noexcept
+		  {
+		  }
+		  template<class U> 
+		  constexpr 
+		  Mmap_allocator(const Mmap_allocator<U>&) 
+		  noexcept
+		  {
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	return allocate_at_least(n).ptr;
+		  }
+		  [[nodiscard]]
+		  Allocation_result
+		  allocate_at_least(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	const std::size_t bytes = M_bytes(n);
+		  	void* p = ::mmap(0, bytes, PROT_READ | PROT_WRITE, 
+		  										MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		  	if (p == MAP_FAILED)
+		  		throw BadAlloc{};
+		  	return Allocation_result{static_cast<pointer>(p), bytes / sizeof(value_type)};
+		  }
+		  // Anonymous mappings are zero pages until written
+		  [[nodiscard]]
+		  pointer
+		  allocate_zeroed(const size_type n)
+		  {
+		  	return allocate(n);
+		  }
+		  // The kernel moves the page mapping, element bytes are not copied.
+		  [[nodiscard]]
+		  Allocation_result
+		  reallocate_at_least(pointer p, 
+		  										const size_type n, 
+		  										const size_type new_n)
+		  {
+		  	if (new_n > max_size())
+		  		return Allocation_result{0, 0};
+		  	const std::size_t bytes = M_bytes(new_n);
+		  	void* q = ::mremap(p, M_bytes(n), bytes, MREMAP_MAYMOVE);
+		  	if (q == MAP_FAILED)
+		  		return Allocation_result{0, 0};
+		  	return Allocation_result{static_cast<pointer>(q), bytes / sizeof(value_type)};
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	::munmap(p, M_bytes(n));
+		  }
+		  static
+		  Alloc_stats*
+		  stats()
+		  {
+		  	return mmap_allocator_stats();
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
 			{
-				return Normal_iterator(M_curr + n);
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
 			}
-			Normal_iterator&
-			operator-=(const difference_type& n)	
-			{
-				M_curr -= n; 
-				return *this;
-			}	
-			Normal_iterator
-			operator-(const difference_type& n)	const
+			void
+			destroy(pointer p) 
 			{
-				return Normal_iterator(M_curr - n);
-			}	
-			const Iter&
-			base() const
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return (std::size_t(-1) / 2) / sizeof(T);
+		  }
+		private:
+			static
+			std::size_t
+			M_bytes(size_type n)
 			{
-				return M_curr;
-			}								
-		protected:
-			Iter M_curr{};
-			
+				static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+				return (n * sizeof(value_type) + page - 1) & ~(page - 1);
+			}
 	};
-	// Forward iterator requirements
-	template <typename ItorL, 
-						typename ItorR, 
-						typename Container>
+	template <class T>
 	inline
 	bool
-	operator==(const Normal_iterator<ItorL, 
-																		Container>& lhs,
-							const Normal_iterator<ItorR, 
-																			Container>& rhs)
+	operator==(const Mmap_allocator<T>&, 
+						const Mmap_allocator<T>&)
 	{
-		return (lhs.base() == rhs.base());
+		return true;
 	}
-	template <typename Itor, 
-						typename Container>
+	template <class T>
 	inline
 	bool
-	operator==(const Normal_iterator<Itor, 
-																		Container>& lhs,
-							const Normal_iterator<Itor, 
-																			Container>& rhs)
+	operator!=(const Mmap_allocator<T>&, 
+						const Mmap_allocator<T>&)
 	{
-		return (lhs.base() == rhs.base());
+		return false;
 	}
-	template <typename ItorL, 
-						typename ItorR, 
-						typename Container>
+	//---	
+	// Huge pages
+	// Anonymous mappings aligned to the 2 MiB huge page size and advised
+	// with MADV_HUGEPAGE, so transparent huge pages can back them and
+	// one TLB entry covers 512 small pages. Sizes are whole huge pages.
+	class
+	Huge_pages
+	{
+		public:
+			static constexpr std::size_t page_size = 2 * 1024 * 1024;
+
+			static
+			std::size_t
+			round(std::size_t bytes)
+			{
+				return (bytes + page_size - 1) & ~(page_size - 1);
+			}
+			// bytes a multiple of page_size, null when out of memory
+			static
+			void*
+			map(std::size_t bytes)
+			{
+				void* p = M_reserve(bytes);
+				if (p)
+				{
+					M_advise(p, bytes);
+					M_advised.fetch_add(bytes, std::memory_order_relaxed);
+				}
+				return p;
+			}
+			static
+			void
+			unmap(void* p, 
+						std::size_t bytes)
+			{
+				::munmap(p, bytes);
+				M_advised.fetch_sub(bytes, std::memory_order_relaxed);
+			}
+			// Grows a mapping in place, or moves its pages to a new aligned
+			// range without copying them. Null, p untouched, on failure.
+			static
+			void*
+			remap(void* p, 
+						std::size_t bytes, 
+						std::size_t new_bytes)
+			{
+				void* q = ::mremap(p, bytes, new_bytes, 0);
+				if (q == MAP_FAILED)
+				{
+					void* target = M_reserve(new_bytes);
+					if (!target)
+					{
+						return 0;
+					}
+					q = ::mremap(p, bytes, new_bytes, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+					if (q == MAP_FAILED)
+					{
+						::munmap(target, new_bytes);
+						return 0;
+					}
+				}
+				M_advise(q, new_bytes);
+				M_advised.fetch_add(new_bytes - bytes, std::memory_order_relaxed);
+				return q;
+			}
+			// Bytes of live mappings advised for huge pages
+			static
+			std::size_t
+			advised_bytes()
+			{
+				return M_advised.load(std::memory_order_relaxed);
+			}
+			// Bytes the kernel really backs with huge pages in advised
+			// mappings, from /proc/self/smaps; 0 where it is not available.
+			static
+			std::size_t
+			resident_bytes()
+			{
+				std::FILE* f = std::fopen("/proc/self/smaps", "r");
+				if (!f)
+				{
+					return 0;
+				}
+				std::size_t total = 0;
+				std::size_t huge_kb = 0;
+				char line[256];
+				while (std::fgets(line, sizeof(line), f))
+				{
+					unsigned long long kb = 0;
+					if (std::sscanf(line, "AnonHugePages: %llu kB", &kb) == 1)
+					{
+						huge_kb = std::size_t(kb);
+					}
+					else if (std::strncmp(line, "VmFlags:", 8) == 0)
+					{
+						// hg: advised with MADV_HUGEPAGE
+						if (std::strstr(line, " hg"))
+						{
+							total += huge_kb * 1024;
+						}
+						huge_kb = 0;
+					}
+				}
+				std::fclose(f);
+				return total;
+			}
+		private:
+			// Maps one page_size more and trims both ends to alignment
+			static
+			void*
+			M_reserve(std::size_t bytes)
+			{
+				void* p = ::mmap(0, bytes + page_size, PROT_READ | PROT_WRITE, 
+													MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED)
+				{
+					return 0;
+				}
+				char* first = static_cast<char*>(p);
+				char* aligned = reinterpret_cast<char*>(
+													(reinterpret_cast<std::uintptr_t>(first) + page_size - 1) & ~(page_size - 1));
+				if (aligned != first)
+				{
+					::munmap(first, std::size_t(aligned - first));
+				}
+				const std::size_t tail = page_size - std::size_t(aligned - first);
+				if (tail)
+				{
+					::munmap(aligned + bytes, tail);
+				}
+				return aligned;
+			}
+			static
+			void
+			M_advise(void* p, 
+								std::size_t bytes)
+			{
+#if defined(MADV_HUGEPAGE)
+				// only a hint, kernels without transparent huge pages refuse it
+				::madvise(p, bytes, MADV_HUGEPAGE);
+#else
+				static_cast<void>(p);
+				static_cast<void>(bytes);
+#endif
+			}
+
+			// Constant initialized, usable before any dynamic initialization
+			static std::atomic<std::size_t> M_advised;
+	};
+	std::atomic<std::size_t> Huge_pages::M_advised{0};
+	// Huge page allocator
+	// Blocks of at least threshold bytes are Huge_pages mappings grown
+	// by remapping their pages, smaller ones come from the global
+	// operator new like Allocator. The threshold, a huge page by
+	// default, travels with the storage.
+	template <class T>
+	class
+	Huge_page_allocator
+	{
+		public:
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+
+		  using propagate_on_container_copy_assignment = type::false_type;
+		  using propagate_on_container_move_assignment = type::true_type;
+		  using propagate_on_container_swap            = type::true_type;
+		  using is_always_equal                        = type::false_type;
+
+		  // Small blocks come from operator new like Allocator
+		  static constexpr std::size_t alignment = Allocator<T>::alignment;
+
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef Huge_page_allocator<T2> other; 
+			};
+			struct
+			Allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+		  constexpr 
+		  Huge_page_allocator() 
+		  noexcept
+		  {
+		  }
+		  explicit
+		  constexpr 
+		  Huge_page_allocator(std::size_t threshold) 
+		  noexcept
+		  	: M_threshold(threshold)
+		  {
+		  }
+		  template<class U> 
+		  constexpr 
+		  Huge_page_allocator(const Huge_page_allocator<U>& other) 
+		  noexcept
+		  	: M_threshold(other.threshold())
+		  {
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	return allocate_at_least(n).ptr;
+		  }
+		  [[nodiscard]]
+		  Allocation_result
+		  allocate_at_least(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	if (!M_huge(n))
+		  		return Allocation_result{new_storage<value_type>(n), n};
+		  	const std::size_t bytes = Huge_pages::round(n * sizeof(value_type));
+		  	void* p = Huge_pages::map(bytes);
+		  	if (!p)
+		  		throw BadAlloc{};
+		  	return Allocation_result{static_cast<pointer>(p), bytes / sizeof(value_type)};
+		  }
+		  // Fresh mappings are zero pages until written
+		  [[nodiscard]]
+		  pointer
+		  allocate_zeroed(const size_type n)
+		  {
+		  	pointer p = allocate(n);
+		  	if (!M_huge(n))
+		  		std::memset(static_cast<void*>(p), 0, n * sizeof(value_type));
+		  	return p;
+		  }
+		  // Only huge blocks grow, the kernel moves their page mapping.
+		  [[nodiscard]]
+		  Allocation_result
+		  reallocate_at_least(pointer p, 
+		  										const size_type n, 
+		  										const size_type new_n)
+		  {
+		  	if (!M_huge(n) || new_n > max_size())
+		  		return Allocation_result{0, 0};
+		  	const std::size_t bytes = Huge_pages::round(new_n * sizeof(value_type));
+		  	void* q = Huge_pages::remap(p, Huge_pages::round(n * sizeof(value_type)), bytes);
+		  	if (!q)
+		  		return Allocation_result{0, 0};
+		  	return Allocation_result{static_cast<pointer>(q), bytes / sizeof(value_type)};
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	if (!M_huge(n))
+		  		delete_storage(p, n);
+		  	else
+		  		Huge_pages::unmap(p, Huge_pages::round(n * sizeof(value_type)));
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
+			{
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
+			}
+			void
+			destroy(pointer p) 
+			{
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return (std::size_t(-1) / 2) / sizeof(T);
+		  }
+		  std::size_t
+		  threshold() const
+		  {
+		  	return M_threshold;
+		  }
+		  static
+		  Alloc_stats*
+		  stats()
+		  {
+		  	return huge_page_allocator_stats();
+		  }
+		private:
+			// Capacities handed out for huge blocks are whole pages, at least
+			// the size asked for, so deallocate takes the same path.
+			bool
+			M_huge(size_type n) const
+			{
+				return n * sizeof(value_type) >= M_threshold;
+			}
+
+			std::size_t M_threshold{Huge_pages::page_size};
+	};
+	template <class T, 
+						class U>
 	inline
 	bool
-	operator!=(const Normal_iterator<ItorL, 
-																		Container>& lhs,
-							const Normal_iterator<ItorR, 
-																			Container>& rhs)
+	operator==(const Huge_page_allocator<T>& lhs, 
+						const Huge_page_allocator<U>& rhs)
 	{
-		return (!(lhs == rhs));
+		return lhs.threshold() == rhs.threshold();
 	}
-	template <typename Itor, 
-						typename Container>
+	template <class T, 
+						class U>
 	inline
 	bool
-	operator!=(const Normal_iterator<Itor, 
-																		Container>& lhs,
-							const Normal_iterator<Itor, 
-																			Container>& rhs)
+	operator!=(const Huge_page_allocator<T>& lhs, 
+						const Huge_page_allocator<U>& rhs)
 	{
-		return  (!(lhs == rhs));
-	}
-	// Random access iterator requirements	
-	template <typename IteratorL, 
-							typename IteratorR, 
-							typename Container>
-	inline 
-	bool
-	operator<(const Normal_iterator<IteratorL, Container>& lhs,
-							const Normal_iterator<IteratorR, Container>& rhs)
-	{ 
-		return lhs.base() < rhs.base(); 
+		return !(lhs == rhs);
 	}
+	//---	
+	// Monotonic arena
+	// Hands out memory from large chunks by bumping a pointer,
+	// individual blocks are never freed, release() frees everything.
+	// The arena must outlive every container using it.
+	class
+	Arena
+	{
+		public:
+			static constexpr std::size_t default_chunk_size = 64 * 1024;
 
-	template <typename Iterator, 
-							typename Container>
-	inline 
-	bool
-	operator<(const Normal_iterator<Iterator, Container>& lhs,
-							const Normal_iterator<Iterator, Container>& rhs)
-	{ 
-		return lhs.base() < rhs.base(); 
-	}
-
-	template <typename IteratorL, 
-							typename IteratorR, 
-							typename Container>
-	inline 
-	bool
-	operator>(const Normal_iterator<IteratorL, Container>& lhs,
-							const Normal_iterator<IteratorR, Container>& rhs)
-	{ 
-		return lhs.base() > rhs.base(); 
-	}
-
-	template <typename Iterator, 
-							typename Container>
-	inline 
-	bool
-	operator>(const Normal_iterator<Iterator, Container>& lhs,
-							const Normal_iterator<Iterator, Container>& rhs)
-	{ 
-		return lhs.base() > rhs.base(); 
-	}
-
-	template <typename IteratorL, 
-							typename IteratorR, 
-							typename Container>
-	inline 
-	bool
-	operator<=(const Normal_iterator<IteratorL, Container>& lhs,
-							const Normal_iterator<IteratorR, Container>& rhs)
-	{ 
-		return lhs.base() <= rhs.base(); 
-	}
-
-	template <typename Iterator, 
-							typename Container>
-	inline 
-	bool
-	operator<=(const Normal_iterator<Iterator, Container>& lhs,
-							const Normal_iterator<Iterator, Container>& rhs)
-	{ 
-		return lhs.base() <= rhs.base(); 
-	}
-
-	template <typename IteratorL, 
-							typename IteratorR, 
-							typename Container>
-	inline 
-	bool
-	operator>=(const Normal_iterator<IteratorL, Container>& lhs,
-							const Normal_iterator<IteratorR, Container>& rhs)
-	{ 
-		return lhs.base() >= rhs.base(); 
-	}
-
-	template <typename Iterator, 
-							typename Container>
-	inline 
-	bool
-	operator>=(const Normal_iterator<Iterator, Container>& lhs,
-							const Normal_iterator<Iterator, Container>& rhs)
-	{ 
-		return lhs.base() >= rhs.base(); 
-	}
-	
-	//
-	template <typename IteratorL, 
-							typename IteratorR, 
-							typename Container>
-	inline 
-	typename Normal_iterator<IteratorL, Container>::difference_type
-	operator-(const Normal_iterator<IteratorL, Container>& lhs,
-						const Normal_iterator<IteratorR, Container>& rhs)
-	{
-		return lhs.base() - rhs.base(); 
-	}
-	
-	template <typename Iterator, 
-							typename Container>
-	inline 
-	typename Normal_iterator<Iterator, Container>::difference_type
-	operator-(const Normal_iterator<Iterator, Container>& lhs,
-						const Normal_iterator<Iterator, Container>& rhs)
-	{
-		return lhs.base() - rhs.base(); 
-	}
-	template<typename Iterator, 
-						typename Container>
-	inline 
-	Normal_iterator<Iterator, Container>
-	operator+(typename Normal_iterator<Iterator, Container>::difference_type n,
-							const Normal_iterator<Iterator, Container>& i)
-	{
-		return Normal_iterator<Iterator, Container>(i.base() + n);
-	}
-		// Reverse iterator
-	template <typename Iter>
-	class
-	Reverse_iterator
-	{
-			typedef type::Iterator_traits<Iter>       Traits_type;	
-		public:
-			using iterator_type											= Iter;		
-			using iterator_category									= typename Traits_type::iterator_category;
-			using value_type												= typename Traits_type::value_type;
-			using difference_type										= typename Traits_type::difference_type;
-			using reference													= typename Traits_type::reference;
-			using pointer														= typename Traits_type::pointer;	
-			
-			Reverse_iterator() 
-				: M_curr() 
-			{ 
-			}
 			explicit
-			Reverse_iterator(iterator_type it) 
-				: M_curr(it) 
-			{ 
+			Arena(std::size_t chunk_size = default_chunk_size)
+				: M_chunk_size(chunk_size)
+			{
 			}
-			template <typename I>
-			Reverse_iterator(const Reverse_iterator<I>& it)
-				: M_curr(it.base())
-			{			
+			// No copy, containers hold a pointer to the arena
+			Arena(const Arena&) = delete;
+			Arena&
+			operator=(const Arena&) = delete;
+			~Arena()
+			{
+				release();
 			}
-			iterator_type
-			base() const
+			void*
+			allocate(std::size_t bytes, 
+								std::size_t align)
 			{
-				return M_curr;
+				// the padding alone may run past the chunk end
+				const std::size_t left = (M_curr ? std::size_t(M_end - M_curr) : 0);
+				std::size_t pad = (M_curr ? M_padding(M_curr, align) : 0);
+				if (!M_curr || pad > left || bytes > left - pad)
+				{
+					// the chunk size below must not wrap
+					if (bytes > std::size_t(-1) - align - sizeof(Chunk))
+					{
+						throw BadAlloc{};
+					}
+					M_new_chunk(bytes + align);
+					pad = M_padding(M_curr, align);
+				}
+				char* p = M_curr + pad;
+				M_curr = p + bytes;
+				M_used += bytes;
+				return p;
 			}
-			reference
-			operator*() const
+			// Only the latest block can be given back
+			void
+			deallocate(void* p, 
+									std::size_t bytes)
+			noexcept
 			{
-				Iter tmp{M_curr};
-				return (*--tmp);
+				if (static_cast<char*>(p) + bytes == M_curr)
+				{
+					M_curr = static_cast<char*>(p);
+					M_used -= bytes;
+				}
 			}
-			pointer
-			operator->() const
+			// Grows the latest block when its chunk has room left
+			bool
+			extend(void* p, 
+							std::size_t bytes, 
+							std::size_t new_bytes)
+			noexcept
 			{
-				return &(operator*());
+				char* block = static_cast<char*>(p);
+				if (block + bytes != M_curr
+							|| new_bytes > std::size_t(M_end - block))
+				{
+					return false;
+				}
+				M_curr = block + new_bytes;
+				M_used += new_bytes - bytes;
+				return true;
 			}
-			Reverse_iterator&
-			operator++()
+			void
+			release()
+			noexcept
 			{
-				--M_curr;
-				return *this;
+				while (M_head)
+				{
+					Chunk* next = M_head->next;
+					::operator delete(static_cast<void*>(M_head), M_head->size);
+					M_head = next;
+				}
+				M_curr = 0;
+				M_end = 0;
+				M_used = 0;
+				M_reserved = 0;
 			}
-			Reverse_iterator
-			operator++(int)
+			// Bytes handed out and not given back
+			std::size_t
+			bytes_used() const
 			{
-				Reverse_iterator tmp = *this;
-				--M_curr;
-				return tmp;
+				return M_used;
 			}
-			Reverse_iterator&
-			operator--()
+			// Bytes held in chunks
+			std::size_t
+			bytes_reserved() const
 			{
-				++M_curr;
-				return *this;
+				return M_reserved;
 			}
-			Reverse_iterator
-			operator--(int)
+		private:
+			struct
+			Chunk
 			{
-				Reverse_iterator tmp = *this;
-				++M_curr;
-				return tmp;
-			}	
-			Reverse_iterator
-			operator+(difference_type n) const
+				Chunk* next;
+				std::size_t size;
+			};
+			Chunk* M_head{0};
+			char* M_curr{0};
+			char* M_end{0};
+			std::size_t M_chunk_size;
+			std::size_t M_used{0};
+			std::size_t M_reserved{0};
+
+			// Bytes from p to the next multiple of align
+			static
+			std::size_t
+			M_padding(const char* p, 
+								std::size_t align)
 			{
-				return Reverse_iterator(M_curr - n);
-			}	
-			Reverse_iterator&
-			operator+=(difference_type n)	
+				const std::uintptr_t v = reinterpret_cast<std::uintptr_t>(p);
+				return (align - v % align) % align;
+			}
+			void
+			M_new_chunk(std::size_t bytes)
 			{
-				M_curr -= n;
-				return *this;
+				std::size_t size = sizeof(Chunk) + bytes;
+				if (size < M_chunk_size)
+				{
+					size = M_chunk_size;
+				}
+				Chunk* chunk = static_cast<Chunk*>(::operator new(size));
+				chunk->next = M_head;
+				chunk->size = size;
+				M_head = chunk;
+				M_curr = reinterpret_cast<char*>(chunk + 1);
+				M_end = reinterpret_cast<char*>(chunk) + size;
+				M_reserved += size;
 			}
-			Reverse_iterator
-			operator-(difference_type n) const
+	};
+	// Arena allocator
+	// Same interface as Allocator, memory comes from an Arena.
+	// A default constructed Arena_allocator has no arena and uses
+	// the global operator new like Allocator.
+	template <class T>
+	class
+	Arena_allocator
+	{
+		public:
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+
+		  // Containers stay on the arena they were built on
+		  using propagate_on_container_copy_assignment = type::false_type;
+		  using propagate_on_container_move_assignment = type::false_type;
+		  using propagate_on_container_swap            = type::false_type;
+		  using is_always_equal                        = type::false_type;
+
+			template <class T2>
+			struct
+			rebind
 			{
-				return Reverse_iterator(M_curr + n);
-			}	
-			Reverse_iterator&
-			operator-=(difference_type n)	
+				typedef Arena_allocator<T2> other; 
+			};
+			struct
+			Allocation_result
 			{
-				M_curr += n;
-				return *this;
+				pointer ptr;
+				size_type count;
+			};
+
+		  constexpr 
+		  Arena_allocator() 
+		  noexcept
+		  {
+		  }
+		  constexpr
+		  Arena_allocator(Arena& arena) 
+		  noexcept
+		  	: M_arena(&arena)
+		  {
+		  }
+		  template<class U> 
+		  constexpr 
+		  Arena_allocator(const Arena_allocator<U>& other) 
+		  noexcept
+		  	: M_arena(other.arena())
+		  {
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	if (!M_arena)
+		  		return new_storage<value_type>(n);
+		  	return static_cast<pointer>(M_arena->allocate(n * sizeof(value_type), 
+		  																									alignof(value_type)));
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	if (!M_arena)
+		  		delete_storage(p, n);
+		  	else
+		  		M_arena->deallocate(p, n * sizeof(value_type));
+		  }
+		  // Growth in place of the latest block of the arena
+		  [[nodiscard]]
+		  Allocation_result
+		  reallocate_at_least(pointer p, 
+		  										const size_type n, 
+		  										const size_type new_n)
+		  {
+		  	if (!M_arena || new_n > max_size()
+		  				|| !M_arena->extend(p, n * sizeof(value_type), new_n * sizeof(value_type)))
+		  	{
+		  		return Allocation_result{0, 0};
+		  	}
+		  	return Allocation_result{p, new_n};
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
+			{
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
 			}
-			reference
-			operator[](difference_type n) const		
+			void
+			destroy(pointer p) 
 			{
-				return *(*this + n);
-			}	
-		protected:
-			Iter M_curr{};	
-	};
-	template<typename Iter>
-	inline
-	bool
-	operator==(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
-	{
-		return (lhs.base() == rhs.base());
-	}
-	template<typename Iter>
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return std::size_t(-1) / sizeof(T);
+		  }
+		  Arena*
+		  arena() const
+		  {
+		  	return M_arena;
+		  }
+		private:
+			Arena* M_arena{0};
+	};
+	template <class T, 
+						class U>
 	inline
 	bool
-	operator!=(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
+	operator==(const Arena_allocator<T>& lhs, 
+						const Arena_allocator<U>& rhs)
 	{
-		return (!(lhs == rhs));
+		return lhs.arena() == rhs.arena();
 	}
-	template<typename Iter>
+	template <class T, 
+						class U>
 	inline
 	bool
-	operator<(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
+	operator!=(const Arena_allocator<T>& lhs, 
+						const Arena_allocator<U>& rhs)
 	{
-		return (rhs.base() < lhs.base());
+		return !(lhs == rhs);
 	}
-	template<typename Iter>
-	inline
-	bool
-	operator>(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
+	//---	
+	// Statistics allocator
+	// Allocator A reporting to the named Alloc_stats given instead of
+	// its own hook, so one container's heap use can be told apart.
+	// A default constructed Stats_allocator reports like A.
+	// The statistics travel with the storage on move and swap.
+	template <class A>
+	class
+	Stats_allocator
+		: public A
 	{
-		return (rhs < lhs);
-	}	
-	template<typename Iter>
+		public:
+		  using propagate_on_container_copy_assignment = type::false_type;
+		  using propagate_on_container_move_assignment = type::true_type;
+		  using propagate_on_container_swap            = type::true_type;
+		  using is_always_equal                        = type::false_type;
+
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef Stats_allocator<typename A::template rebind<T2>::other> other; 
+			};
+
+		  Stats_allocator() 
+		  	: A()
+		  {
+		  }
+		  explicit
+		  Stats_allocator(Alloc_stats& stats, 
+		  								const A& upstream = A()) 
+		  	: A(upstream), M_stats(&stats)
+		  {
+		  }
+		  template<class B> 
+		  Stats_allocator(const Stats_allocator<B>& other) 
+		  	: A(other.upstream()), M_stats(other.named_stats())
+		  {
+		  }
+		  Alloc_stats*
+		  stats() const
+		  {
+		  	return (M_stats ? M_stats : alloc_stats(upstream()));
+		  }
+		  // Null when default constructed
+		  Alloc_stats*
+		  named_stats() const
+		  {
+		  	return M_stats;
+		  }
+		  const A&
+		  upstream() const
+		  {
+		  	return *this;
+		  }
+		private:
+			Alloc_stats* M_stats{0};
+	};
+	template <class A, 
+						class B>
 	inline
 	bool
-	operator<=(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
+	operator==(const Stats_allocator<A>& lhs, 
+						const Stats_allocator<B>& rhs)
 	{
-		return (!(rhs < lhs));
+		return lhs.named_stats() == rhs.named_stats() && lhs.upstream() == rhs.upstream();
 	}
-	template<typename Iter>
+	template <class A, 
+						class B>
 	inline
 	bool
-	operator>=(const Reverse_iterator<Iter>& lhs,
-							const Reverse_iterator<Iter>& rhs)
-	{
-		return (!(lhs < rhs));
-	}		
-	//---
-	// Initialization helpers
-	template<class InputIterator, 
-					class A>
-	void 
-	destroy_a(InputIterator first, 
-							InputIterator last, 
-							A alloc)
-	noexcept(true)
-	{
-		for (; first != last; ++first)
-			alloc.destroy(std::addressof(*first));	
-	}	
-		
-	template<class InputIterator, 
-					class A>
-	void 
-	uninitialized_fill_a(InputIterator first, 
-												InputIterator last, 
-												A alloc)
-	noexcept(false)
+	operator!=(const Stats_allocator<A>& lhs, 
+						const Stats_allocator<B>& rhs)
 	{
-		typedef 
-		typename type::Iterator_traits<InputIterator>::value_type
-		ValueType;
-		
-		InputIterator current = first;
-		try
-		{
-			for (; current != last; ++current)
-				alloc.construct(std::addressof(*current), ValueType());
-		}
-		catch(...)
-		{
-			//for (; first != current; ++first)
-			//	alloc.destroy(std::addressof(*first));
-			destroy_a(first,current,alloc);
-			throw std::runtime_error{"Default initialization failed"};			
-		}
+		return !(lhs == rhs);
 	}
-	
-	template<typename ForwardIterator, 
-						typename Size, 
-						typename T,
-						typename A>
-	void
-	uninitialized_fill_n_a(ForwardIterator first, 
-													Size n,
-													const T& val, 
-													A& alloc)
+	//---	
+	// Memory mapped file
+	// A heap in a file mapped shared, so element stores are file writes
+	// and a restart maps the previous state back, pages read on demand.
+	// Blocks are carved by bumping the end of the file; like Arena only
+	// the latest block is given back or grown, in place. The file grows
+	// with ftruncate inside an address range reserved up front, so
+	// mapped blocks never move.
+	// One block may be recorded as root with its element count, the one
+	// a program finds again after reopening the file. The root block is
+	// kept when its container deallocates it.
+	// Other freed blocks stay in the file until it is opened again: the
+	// root is all a new run can reach, so opening moves it to the front
+	// and trims the file behind it.
+	// Not thread safe. The file must outlive every container using it.
+	class
+	Mapped_file
 	{
-		ForwardIterator curr = first;
-		try
-		{
-			for (; n > 0; --n, ++curr)
+		public:
+			static constexpr std::size_t default_reserve = std::size_t(1) << 36;
+			// Blocks start on a cache line
+			static constexpr std::size_t alignment = 64;
+
+			explicit
+			Mapped_file(const char* path, 
+									std::size_t reserve = default_reserve)
+				: M_reserve(M_round_page(reserve))
 			{
-				alloc.construct(std::addressof(*curr), val);
+				M_fd = ::open(path, O_RDWR | O_CREAT, 0644);
+				struct stat st;
+				if (M_fd < 0 || ::fstat(M_fd, &st) != 0)
+				{
+					M_close();
+					throw std::runtime_error{"Mapped_file cannot open file"};
+				}
+				void* base = ::mmap(0, M_reserve, PROT_NONE, 
+														MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+				if (base == MAP_FAILED)
+				{
+					M_close();
+					throw BadAlloc{};
+				}
+				M_base = static_cast<char*>(base);
+				const std::size_t size = std::size_t(st.st_size);
+				if (size > M_reserve || !M_map(size ? size : M_header_bytes()))
+				{
+					M_close();
+					throw BadAlloc{};
+				}
+				if (size == 0)
+				{
+					M_header()->magic = M_magic;
+					M_header()->top = M_header_bytes();
+				}
+				else if (size < sizeof(Header) || M_header()->magic != M_magic 
+									|| M_header()->top > size || !M_root_fits())
+				{
+					M_close();
+					throw std::runtime_error{"Mapped_file not a mapped heap"};
+				}
+				else
+				{
+					M_compact();
+				}
 			}
-		}
-		catch(...)
-		{
-			destroy_a(first, curr, alloc);
-			throw std::runtime_error{"Default initialization failed"};						
-		}
-	}
-	
-	template<class InputIterator,
-						class ForwardIterator, 
-						class A>
-	ForwardIterator 
-	uninitialized_copy_a(InputIterator first, 
-												InputIterator last,
-												ForwardIterator	result, 
-												A alloc)
-	noexcept(false)
-	{
-		ForwardIterator curr{result};
-		try
-		{
-			for (; first != last; ++first, ++curr)
+			// No copy, containers hold a pointer to the file
+			Mapped_file(const Mapped_file&) = delete;
+			Mapped_file&
+			operator=(const Mapped_file&) = delete;
+			~Mapped_file()
 			{
-				alloc.construct(std::addressof(*curr), *first);
+				M_close();
 			}
-			return curr;
-		}
-		catch(...)
-		{
-			destroy_a(result, curr, alloc);
-			throw std::runtime_error{"Copy initialization failed"};						
-		}
-	
-	}
-	
-	template<typename InputIterator, 
-						typename ForwardIterator>
-	ForwardIterator
-	copy(InputIterator first, 
-	 			InputIterator last,
-	 			ForwardIterator result)
-	{
-	 	for (; first != last; (void)++first, (void)++result)
-	 	{
-	 		*result = *first;
-	 	}
-	 	return result;
-	}
-	
-	template<typename ForwardIt, 
-						typename T>
-	void 
-	fill(ForwardIt first, 
-				ForwardIt last, 
-				const T& val)
-	{
-		for (; first != last; ++first)
-			*first = val;
-	}
-	
-	template<typename OutputIt, 
-						typename Size, 
-						typename T>		
-	OutputIt 
-	fill_n(OutputIt result, 
-					Size count, 
-					const T& val)
-	{
-		for (Size i = 0; i < count; i++)
-			*result++ = val;
-		return result;
-	}
-	
-	template <typename InputIterator, 
-							typename OutputIterator>	
-	OutputIterator
-	move_backward(InputIterator first, 
-									InputIterator last,
-									OutputIterator result)
-	{
-		while (first != last)
-		{
-			*(--result) = std::move(*(--last));
-		}
-		return result;
-	}
-	
-	template <typename InputIt, 
-							typename NoThrowForwardIt,
-							typename	Alloc>
-	NoThrowForwardIt 
-	uninitialized_move_a(InputIt first, 
-											InputIt last, 
-											NoThrowForwardIt d_first,
-											Alloc a)
-	{
-		NoThrowForwardIt current = d_first;
-		try
-		{
-			for (; first != last; ++first, (void) ++current) 
+			void*
+			allocate(std::size_t bytes, 
+								std::size_t align)
 			{
-				a.construct(current, std::move(*first));
+				const std::size_t a = (align > alignment ? align : alignment);
+				const std::size_t off = (M_header()->top + a - 1) & ~(a - 1);
+				if (off > M_reserve || bytes > M_reserve - off || !M_map(off + bytes))
+				{
+					throw BadAlloc{};
+				}
+				M_header()->top = off + bytes;
+				return M_base + off;
 			}
-			return current;
-		}
-		catch(...)
-		{
-			destroy_a(d_first, current,a);
-			throw std::runtime_error{"Move initialization failed"};						
-		}
-	}
-	//---	
-}
-//--- NS lib_impl
-//-- User library
-namespace
-lib
-{
-  // MISRA C++
-  // Compliant Rule 7–3–4 and Rule 7–3–6
-  // using-directives and using-declarations shall not be used
-  // (excluding class scope or function scope using-declarations)
-
-	// Vector Base
-	// Memory management
-	// Nothing construct or destroy T elements
-	template <typename T, 
-							typename A>
+			// Only the latest block can be given back, the root is kept
+			void
+			deallocate(void* p, 
+									std::size_t bytes)
+			noexcept
+			{
+				const std::size_t off = M_offset(p);
+				if (off != M_header()->root && off + bytes == M_header()->top)
+				{
+					M_header()->top = off;
+				}
+			}
+			// Grows the latest block in place
+			bool
+			extend(void* p, 
+							std::size_t bytes, 
+							std::size_t new_bytes)
+			noexcept
+			{
+				const std::size_t off = M_offset(p);
+				if (off + bytes != M_header()->top 
+						|| new_bytes > M_reserve - off || !M_map(off + new_bytes))
+				{
+					return false;
+				}
+				M_header()->top = off + new_bytes;
+				return true;
+			}
+			// Root block, p null for none
+			void
+			set_root(const void* p, 
+								std::size_t size, 
+								std::size_t capacity, 
+								std::size_t element_size)
+			noexcept
+			{
+				Header* h = M_header();
+				h->root = (p ? M_offset(p) : 0);
+				h->root_size = size;
+				h->root_capacity = capacity;
+				h->element_size = element_size;
+			}
+			void*
+			root() const
+			noexcept
+			{
+				return (M_header()->root ? M_base + M_header()->root : 0);
+			}
+			std::size_t
+			root_size() const
+			noexcept
+			{
+				return M_header()->root_size;
+			}
+			std::size_t
+			root_capacity() const
+			noexcept
+			{
+				return M_header()->root_capacity;
+			}
+			std::size_t
+			root_element_size() const
+			noexcept
+			{
+				return M_header()->element_size;
+			}
+			// Waits until the pages written so far are on disk
+			void
+			sync()
+			{
+				if (::msync(M_base, M_mapped, MS_SYNC) != 0)
+				{
+					throw std::runtime_error{"Mapped_file sync failed"};
+				}
+			}
+			// Whether [p, p + bytes) lies in the blocks of the file
+			bool
+			owns(const void* p, 
+						std::size_t bytes) const
+			noexcept
+			{
+				const std::less<const void*> less{};
+				if (less(p, M_base + M_header_bytes()) || !less(p, M_base + M_header()->top))
+				{
+					return false;
+				}
+				return bytes <= M_header()->top - M_offset(p);
+			}
+			// Bytes up to the end of the latest block
+			std::size_t
+			bytes_used() const
+			noexcept
+			{
+				return M_header()->top;
+			}
+			// Size of the file
+			std::size_t
+			bytes_mapped() const
+			noexcept
+			{
+				return M_mapped;
+			}
+		private:
+			struct
+			Header
+			{
+				std::uint64_t magic;
+				// end of the latest block
+				std::uint64_t top;
+				std::uint64_t root;
+				std::uint64_t root_size;
+				std::uint64_t root_capacity;
+				std::uint64_t element_size;
+			};
+			// "LIBHEAP1"
+			static constexpr std::uint64_t M_magic = 0x315041454842494cULL;
+
+			int M_fd{-1};
+			char* M_base{0};
+			std::size_t M_mapped{0};
+			std::size_t M_reserve;
+
+			static
+			std::size_t
+			M_page()
+			{
+				static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+				return page;
+			}
+			static
+			std::size_t
+			M_round_page(std::size_t bytes)
+			{
+				return (bytes + M_page() - 1) & ~(M_page() - 1);
+			}
+			// The header takes the first page, blocks start page aligned
+			static
+			std::size_t
+			M_header_bytes()
+			{
+				return M_page();
+			}
+			Header*
+			M_header() const
+			noexcept
+			{
+				return reinterpret_cast<Header*>(M_base);
+			}
+			std::size_t
+			M_offset(const void* p) const
+			noexcept
+			{
+				return std::size_t(static_cast<const char*>(p) - M_base);
+			}
+			// Root block inside [header, top)
+			bool
+			M_root_fits() const
+			noexcept
+			{
+				const Header* h = M_header();
+				if (!h->root)
+				{
+					return true;
+				}
+				return h->root >= M_header_bytes() && h->root <= h->top 
+								&& h->element_size != 0 && h->root_size <= h->root_capacity
+								&& h->root_capacity <= (h->top - h->root) / h->element_size;
+			}
+			// Moves the root block to the first block and trims the file
+			// behind it, dropping the blocks of the previous run
+			void
+			M_compact()
+			noexcept
+			{
+				Header* h = M_header();
+				const std::size_t first = M_header_bytes();
+				const std::size_t bytes = (h->root ? h->root_capacity * h->element_size : 0);
+				if (h->root > first)
+				{
+					std::memmove(M_base + first, M_base + h->root, bytes);
+					h->root = first;
+				}
+				h->top = first + bytes;
+				// pages past the new end are mapped again by M_map
+				const std::size_t size = M_round_page(h->top);
+				if (size < M_mapped && ::ftruncate(M_fd, off_t(size)) == 0)
+				{
+					M_mapped = size;
+				}
+			}
+			// Maps the file up to at least bytes, at least doubling it
+			bool
+			M_map(std::size_t bytes)
+			noexcept
+			{
+				if (bytes <= M_mapped)
+				{
+					return true;
+				}
+				std::size_t size = M_round_page(bytes > 2 * M_mapped ? bytes : 2 * M_mapped);
+				if (size > M_reserve)
+				{
+					size = M_reserve;
+				}
+				struct stat st;
+				if (::fstat(M_fd, &st) != 0 
+						|| (std::size_t(st.st_size) < size && ::ftruncate(M_fd, off_t(size)) != 0))
+				{
+					return false;
+				}
+				void* p = ::mmap(M_base + M_mapped, size - M_mapped, PROT_READ | PROT_WRITE,
+													MAP_SHARED | MAP_FIXED, M_fd, off_t(M_mapped));
+				if (p == MAP_FAILED)
+				{
+					return false;
+				}
+				M_mapped = size;
+				return true;
+			}
+			void
+			M_close()
+			noexcept
+			{
+				if (M_base)
+				{
+					::munmap(M_base, M_reserve);
+					M_base = 0;
+				}
+				if (M_fd >= 0)
+				{
+					::close(M_fd);
+					M_fd = -1;
+				}
+			}
+	};
+	// File allocator
+	// Same interface as Arena_allocator, memory comes from a Mapped_file.
+	// A default constructed File_allocator has no file and uses
+	// the global operator new like Allocator.
+	// Only for trivially copyable T, the bytes in the file are the
+	// objects when it is mapped again.
+	template <class T>
+	class
+	File_allocator
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+									"File_allocator elements are kept as file bytes");
+		public:
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+
+		  // Containers stay in the file they were built in
+		  using propagate_on_container_copy_assignment = type::false_type;
+		  using propagate_on_container_move_assignment = type::false_type;
+		  using propagate_on_container_swap            = type::false_type;
+		  using is_always_equal                        = type::false_type;
+
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef File_allocator<T2> other; 
+			};
+			struct
+			Allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+		  constexpr 
+		  File_allocator() 
+		  noexcept
+		  {
+		  }
+		  constexpr
+		  File_allocator(Mapped_file& file) 
+		  noexcept
+		  	: M_file(&file)
+		  {
+		  }
+		  template<class U> 
+		  constexpr 
+		  File_allocator(const File_allocator<U>& other) 
+		  noexcept
+		  	: M_file(other.file())
+		  {
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	if (!M_file)
+		  		return new_storage<value_type>(n);
+		  	return static_cast<pointer>(M_file->allocate(n * sizeof(value_type), 
+		  																							alignof(value_type)));
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	if (!M_file)
+		  		delete_storage(p, n);
+		  	else
+		  		M_file->deallocate(p, n * sizeof(value_type));
+		  }
+		  // Growth in place of the latest block of the file
+		  [[nodiscard]]
+		  Allocation_result
+		  reallocate_at_least(pointer p, 
+		  										const size_type n, 
+		  										const size_type new_n)
+		  {
+		  	if (!M_file || new_n > max_size()
+		  				|| !M_file->extend(p, n * sizeof(value_type), new_n * sizeof(value_type)))
+		  	{
+		  		return Allocation_result{0, 0};
+		  	}
+		  	return Allocation_result{p, new_n};
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
+			{
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
+			}
+			void
+			destroy(pointer p) 
+			{
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return std::size_t(-1) / sizeof(T);
+		  }
+		  Mapped_file*
+		  file() const
+		  {
+		  	return M_file;
+		  }
+		private:
+			Mapped_file* M_file{0};
+	};
+	template <class T, 
+						class U>
+	inline
+	bool
+	operator==(const File_allocator<T>& lhs, 
+						const File_allocator<U>& rhs)
+	{
+		return lhs.file() == rhs.file();
+	}
+	template <class T, 
+						class U>
+	inline
+	bool
+	operator!=(const File_allocator<T>& lhs, 
+						const File_allocator<U>& rhs)
+	{
+		return !(lhs == rhs);
+	}
+	//---	
+	// Size class pool
+	// Small and medium blocks are served from per-thread free lists.
+	// Lists are refilled from, and overflow returned to, a global depot
+	// in batches, so the depot lock is taken once per batch. The depot
+	// carves blocks out of slabs taken from the global operator new,
+	// slabs are kept for the life of the program.
 	struct
-	Vector_base
+	Pool_stats
 	{
-		typedef typename A::template rebind<T>::other T_alloc_type;
-		struct 
-		Vector_impl
-			: public T_alloc_type
+		std::uint64_t hits;
+		std::uint64_t misses;
+		std::uint64_t large;
+		std::uint64_t slab_bytes;
+
+		// Share of pooled allocations served by the thread cache
+		double
+		hit_rate() const
 		{
-			// Representation
-			typename T_alloc_type::pointer M_start{};
-			typename T_alloc_type::pointer M_finish{};	
-			typename T_alloc_type::pointer M_end{};	
+			const std::uint64_t total = hits + misses;
+			return (total ? double(hits) / double(total) : 0.0);
+		}
+	};
+	class
+	Pool
+	{
+		public:
+			// Two classes per power of two: 16, 24, 32, 48, ... 32768 bytes
+			static constexpr std::size_t classes = 23;
+			static constexpr std::size_t max_block = 32768;
+			static constexpr std::size_t alignment = 16;
+
+			static
+			constexpr
+			std::size_t
+			class_size(std::size_t c)
+			{
+				return (c % 2 == 0 ? std::size_t(16) << (c / 2)
+													 : std::size_t(24) << (c / 2));
+			}
+			static
+			std::size_t
+			class_of(std::size_t bytes)
+			{
+				std::size_t c = 0;
+				while (class_size(c) < bytes)
+				{
+					++c;
+				}
+				return c;
+			}
+			// bytes must not exceed max_block
+			static
+			void*
+			allocate(std::size_t bytes)
+			{
+				const std::size_t c = class_of(bytes);
+				if (M_cache_done)
+				{
+					// A depot batch comes back whole: keep one block, return the rest
+					Block* b = 0;
+					const std::size_t k = M_refill(c, b, 1);
+					if (b->next)
+					{
+						M_give_back(c, b->next, k - 1);
+						b->next = 0;
+					}
+					return b;
+				}
+				Cache& cache = M_cache;
+				Bin& bin = cache.bins[c];
+				if (bin.head)
+				{
+					++cache.hits;
+				}
+				else
+				{
+					++cache.misses;
+					M_flush_stats(cache);
+					bin.count = M_refill(c, bin.head, M_batch(c));
+				}
+				Block* b = bin.head;
+				bin.head = b->next;
+				--bin.count;
+				return b;
+			}
+			static
+			void
+			deallocate(void* p, 
+									std::size_t bytes)
+			noexcept
+			{
+				const std::size_t c = class_of(bytes);
+				Block* b = static_cast<Block*>(p);
+				if (M_cache_done)
+				{
+					b->next = 0;
+					M_give_back(c, b, 1);
+					return;
+				}
+				Bin& bin = M_cache.bins[c];
+				b->next = bin.head;
+				bin.head = b;
+				if (++bin.count >= 2 * M_batch(c))
+				{
+					M_return_batch(c, bin);
+				}
+			}
+			static
+			void
+			count_large()
+			noexcept
+			{
+				M_large.fetch_add(1, std::memory_order_relaxed);
+			}
+			// Hits of other running threads are added on their next miss
+			static
+			Pool_stats
+			stats()
+			{
+				const bool local = !M_cache_done;
+				return Pool_stats{M_hits.load(std::memory_order_relaxed) + (local ? M_cache.hits : 0),
+													M_misses.load(std::memory_order_relaxed) + (local ? M_cache.misses : 0),
+													M_large.load(std::memory_order_relaxed),
+													M_slab_bytes.load(std::memory_order_relaxed)};
+			}
+		private:
+			struct
+			Block
+			{
+				Block* next;
+				// chains batches in the depot
+				Block* next_batch;
+			};
+			struct
+			Bin
+			{
+				Block* head;
+				std::size_t count;
+			};
+			struct
+			Cache
+			{
+				Bin bins[classes];
+				std::uint64_t hits;
+				std::uint64_t misses;
+				// Everything goes back to the depot on thread exit
+				~Cache()
+				{
+					M_cache_done = true;
+					for (std::size_t c = 0; c != classes; ++c)
+					{
+						if (bins[c].head)
+						{
+							M_give_back(c, bins[c].head, bins[c].count);
+						}
+					}
+					M_flush_stats(*this);
+				}
+			};
+			struct
+			Depot
+			{
+				std::mutex lock;
+				Block* batches;
+				std::size_t count;
+			};
+
+			static
+			std::size_t
+			M_batch(std::size_t c)
+			{
+				const std::size_t n = 16 * 1024 / class_size(c);
+				return (n < 4 ? 4 : (n > 64 ? 64 : n));
+			}
+			static
+			void
+			M_flush_stats(Cache& cache)
+			noexcept
+			{
+				M_hits.fetch_add(cache.hits, std::memory_order_relaxed);
+				M_misses.fetch_add(cache.misses, std::memory_order_relaxed);
+				cache.hits = 0;
+				cache.misses = 0;
+			}
+			// Takes a batch of up to n blocks from the depot into head,
+			// carving a new slab when the depot is empty.
+			static
+			std::size_t
+			M_refill(std::size_t c, 
+								Block*& head, 
+								std::size_t n)
+			{
+				Depot& depot = M_depots[c];
+				{
+					std::lock_guard<std::mutex> guard(depot.lock);
+					if (depot.batches)
+					{
+						head = depot.batches;
+						depot.batches = head->next_batch;
+						std::size_t k = 1;
+						for (Block* b = head; b->next; b = b->next)
+						{
+							++k;
+						}
+						depot.count -= k;
+						return k;
+					}
+				}
+				const std::size_t size = class_size(c);
+				const std::size_t slab = (64 * 1024 > n * size ? 64 * 1024 : n * size);
+				char* mem = static_cast<char*>(::operator new(slab));
+				M_slab_bytes.fetch_add(slab, std::memory_order_relaxed);
+				const std::size_t blocks = slab / size;
+				// first n blocks to the caller, the rest to the depot
+				Block* first = 0;
+				Block* rest = 0;
+				for (std::size_t i = blocks; i-- > 0; )
+				{
+					Block* b = reinterpret_cast<Block*>(mem + i * size);
+					if (i < n)
+					{
+						b->next = first;
+						first = b;
+					}
+					else
+					{
+						b->next = rest;
+						rest = b;
+					}
+				}
+				if (rest)
+				{
+					M_give_back(c, rest, blocks - n);
+				}
+				head = first;
+				return n;
+			}
+			// Keeps one batch in the cache, the rest goes to the depot
+			static
+			void
+			M_return_batch(std::size_t c, 
+											Bin& bin)
+			noexcept
+			{
+				const std::size_t keep = M_batch(c);
+				Block* tail = bin.head;
+				for (std::size_t i = 1; i < keep; ++i)
+				{
+					tail = tail->next;
+				}
+				Block* extra = tail->next;
+				tail->next = 0;
+				M_give_back(c, extra, bin.count - keep);
+				bin.count = keep;
+			}
+			// Hands a list of n blocks to the depot in batches
+			static
+			void
+			M_give_back(std::size_t c, 
+									Block* head, 
+									std::size_t n)
+			noexcept
+			{
+				const std::size_t batch = M_batch(c);
+				Depot& depot = M_depots[c];
+				std::lock_guard<std::mutex> guard(depot.lock);
+				depot.count += n;
+				while (head)
+				{
+					Block* first = head;
+					Block* last = head;
+					for (std::size_t i = 1; i < batch && last->next; ++i)
+					{
+						last = last->next;
+					}
+					head = last->next;
+					last->next = 0;
+					first->next_batch = depot.batches;
+					depot.batches = first;
+				}
+			}
+
+			static Depot M_depots[classes];
+			static std::atomic<std::uint64_t> M_hits;
+			static std::atomic<std::uint64_t> M_misses;
+			static std::atomic<std::uint64_t> M_large;
+			static std::atomic<std::uint64_t> M_slab_bytes;
+			static thread_local Cache M_cache;
+			static thread_local bool M_cache_done;
+	};
+	Pool::Depot Pool::M_depots[Pool::classes]{};
+	std::atomic<std::uint64_t> Pool::M_hits{0};
+	std::atomic<std::uint64_t> Pool::M_misses{0};
+	std::atomic<std::uint64_t> Pool::M_large{0};
+	std::atomic<std::uint64_t> Pool::M_slab_bytes{0};
+	thread_local Pool::Cache Pool::M_cache{};
+	thread_local bool Pool::M_cache_done = false;
+
+	// Pool allocator
+	// Same interface as Allocator, blocks up to Pool::max_block bytes
+	// come from the Pool, larger ones from the global operator new.
+	template <class T>
+	class
+	Pool_allocator
+	{
+		public:
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+		  // One process-wide pool
+		  using propagate_on_container_move_assignment = type::true_type;
+		  using is_always_equal                        = type::true_type;
+
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef Pool_allocator<T2> other; 
+			};
+			struct
+			Allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+		  constexpr 
+		  Pool_allocator() 
+		  noexcept
+		  {
+		  }
+		  template<class U> 
+		  constexpr 
+		  Pool_allocator(const Pool_allocator<U>&) 
+		  noexcept
+		  {
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	if (n > max_size())
+		  		throw BadAlloc{};
+		  	const std::size_t bytes = n * sizeof(value_type);
+		  	if (!M_pooled(bytes))
+		  	{
+		  		Pool::count_large();
+		  		return new_storage<value_type>(n);
+		  	}
+		  	return static_cast<pointer>(Pool::allocate(bytes));
+		  }
+		  // The whole size class block is usable
+		  [[nodiscard]]
+		  Allocation_result
+		  allocate_at_least(const size_type n)
+		  {
+		  	pointer p = allocate(n);
+		  	return Allocation_result{p, good_size(n)};
+		  }
+		  size_type
+		  good_size(const size_type n) const
+		  {
+		  	const std::size_t bytes = n * sizeof(value_type);
+		  	if (!M_pooled(bytes))
+		  		return n;
+		  	return Pool::class_size(Pool::class_of(bytes)) / sizeof(value_type);
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	const std::size_t bytes = n * sizeof(value_type);
+		  	if (!M_pooled(bytes))
+		  		delete_storage(p, n);
+		  	else
+		  		Pool::deallocate(p, bytes);
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
+			{
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
+			}
+			void
+			destroy(pointer p) 
+			{
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return std::size_t(-1) / sizeof(T);
+		  }
+		private:
+			static
+			constexpr
+			bool
+			M_pooled(std::size_t bytes)
+			{
+				return (bytes != 0 && bytes <= Pool::max_block 
+								&& alignof(value_type) <= Pool::alignment);
+			}
+	};
+	template <class T, 
+						class U>
+	inline
+	bool
+	operator==(const Pool_allocator<T>&, 
+						const Pool_allocator<U>&)
+	{
+		return true;
+	}
+	template <class T, 
+						class U>
+	inline
+	bool
+	operator!=(const Pool_allocator<T>&, 
+						const Pool_allocator<U>&)
+	{
+		return false;
+	}
+	//---	
+	// Inline allocator
+	// Holds storage for N elements inside the allocator object itself,
+	// so inside the container which derives from it, like Array's M_instance.
+	// The first request of at most N elements is served from it,
+	// everything else from the upstream allocator A.
+	// Copies start with their own unused storage and never compare equal.
+	template <class T, 
+						std::size_t N,
+						class A = Allocator<T>>
+	class
+	Inline_allocator
+	{
+		public:
+		  using value_type                             = T;
+		  using size_type                              = std::size_t;
+		  using difference_type                        = std::ptrdiff_t;
+		  using pointer                             	 = T*;
+		  using const_pointer                          = const T*;
+		  using reference                      	 			 = T&;    		  		  
+		  using const_reference                      	 = const T&;    
+		  using upstream_type                          = A;
+		  // Inline storage never moves with the allocator
+		  using propagate_on_container_copy_assignment = type::false_type;
+		  using propagate_on_container_move_assignment = type::false_type;
+		  using propagate_on_container_swap            = type::false_type;
+		  using is_always_equal                        = type::false_type;
+
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef Inline_allocator<T2, N, typename A::template rebind<T2>::other> other; 
+			};
+			struct
+			Allocation_result
+			{
+				pointer ptr;
+				size_type count;
+			};
+
+		  Inline_allocator() 
+		  	: M_upstream(), 
+		  		M_used(false)
+		  {
+		  }
+		  explicit
+		  Inline_allocator(const A& a) 
+		  	: M_upstream(a), 
+		  		M_used(false)
+		  {
+		  }
+		  Inline_allocator(const Inline_allocator& other) 
+		  	: M_upstream(other.M_upstream), 
+		  		M_used(false)
+		  {
+		  }
+		  Inline_allocator&
+		  operator=(const Inline_allocator& other)
+		  {
+		  	M_upstream = other.M_upstream;
+		  	return *this;
+		  }
+		  [[nodiscard]] 
+		  pointer 
+		  allocate(const size_type n)
+		  {
+		  	if (!M_used && n <= N)
+		  	{
+		  		M_used = true;
+		  		return inline_data();
+		  	}
+		  	return M_upstream.allocate(n);
+		  }
+		  // The inline storage is always handed out whole
+		  [[nodiscard]]
+		  Allocation_result
+		  allocate_at_least(const size_type n)
+		  {
+		  	if (!M_used && n <= N)
+		  	{
+		  		M_used = true;
+		  		return Allocation_result{inline_data(), N};
+		  	}
+		  	return M_upstream_allocate_at_least(n, type::has_allocate_at_least<A>());
+		  }
+		  void 
+		  deallocate(pointer p, const size_type n)
+		  {
+		  	if (p == inline_data())
+		  		M_used = false;
+		  	else
+		  		M_upstream.deallocate(p, n);
+		  }
+			template <typename... Args>
+			void
+			construct(pointer p, 
+									Args&&... args)
+			{
+				::new( static_cast<void*>(p) ) T(std::forward<Args>(args)...);
+			}
+			void
+			destroy(pointer p) 
+			{
+				p->~T(); 
+			}    
+		  size_type
+		  max_size() const
+		  {
+		  	return M_upstream.max_size();
+		  }
+		  pointer
+		  inline_data()
+		  {
+		  	return reinterpret_cast<pointer>(M_buffer);
+		  }
+		  const_pointer
+		  inline_data() const
+		  {
+		  	return reinterpret_cast<const_pointer>(M_buffer);
+		  }
+		  const A&
+		  upstream() const
+		  {
+		  	return M_upstream;
+		  }
+		  bool
+		  operator==(const Inline_allocator& other) const
+		  {
+		  	return (this == &other);
+		  }
+		  bool
+		  operator!=(const Inline_allocator& other) const
+		  {
+		  	return (this != &other);
+		  }
+		private:
+			Allocation_result
+			M_upstream_allocate_at_least(const size_type n, 
+																		type::true_type)
+			{
+				auto result = M_upstream.allocate_at_least(n);
+				return Allocation_result{result.ptr, result.count};
+			}
+			Allocation_result
+			M_upstream_allocate_at_least(const size_type n, 
+																		type::false_type)
+			{
+				return Allocation_result{M_upstream.allocate(n), n};
+			}
+
+			A M_upstream;
+			bool M_used;
+			alignas(T) unsigned char M_buffer[(N ? N : 1) * sizeof(T)];
+	};
+	//---	
+	// Range checking policies for element access
+	struct
+	Range_checked
+	{
+		static
+		void
+		check(std::size_t n, 
+					std::size_t size)
+		{
+			if (n >= size)
+			{
+				throw std::runtime_error{"Vector::M_range_check"};
+			}
+		}
+	};
+	struct
+	Range_unchecked
+	{
+		static
+		constexpr
+		void
+		check(std::size_t, 
+					std::size_t)
+		noexcept
+		{
+		}
+	};
+	// Release builds drop the checks, LIB_CHECKED_SUBSCRIPT keeps them.
+#if defined(NDEBUG) && !defined(LIB_CHECKED_SUBSCRIPT)
+	using Subscript_check										= Range_unchecked;
+#else
+	using Subscript_check										= Range_checked;
+#endif
+	//---	
+	// Growth policies
+	// New capacity, in elements, for a container of size elements
+	// which needs room for n more.
+	template <std::size_t Num,
+							std::size_t Den>
+	struct
+	Growth_factor
+	{
+		static_assert(Num > Den, "Growth factor must be larger than one");
+
+		template <typename Alloc>
+		static
+		std::size_t
+		next(std::size_t size,
+					std::size_t n,
+					const Alloc&)
+		{
+			const std::size_t grow = size / Den * (Num - Den) 
+																+ size % Den * (Num - Den) / Den;
+			return size + std::max(grow, n);
+		}
+	};
+	// 2x, historic Vector behaviour
+	using Growth_double											= Growth_factor<2, 1>;
+	// 1.5x, freed blocks can be reused by later growth steps
+	using Growth_golden											= Growth_factor<3, 2>;
+
+	// Whole pages once a buffer reaches PageSize bytes.
+	template <typename Base = Growth_golden,
+							std::size_t PageSize = 4096>
+	struct
+	Growth_page
+	{
+		template <typename Alloc>
+		static
+		std::size_t
+		next(std::size_t size,
+					std::size_t n,
+					const Alloc& alloc)
+		{
+			constexpr std::size_t elem = sizeof(typename Alloc::value_type);
+			const std::size_t len = Base::next(size, n, alloc);
+			if (len > std::size_t(-1) / elem - PageSize)
+				return len;
+			const std::size_t bytes = len * elem;
+			if (bytes < PageSize)
+				return len;
+			return ((bytes + PageSize - 1) & ~(PageSize - 1)) / elem;
+		}
+	};
+
+	// Rounded up to the size class the allocator really hands out.
+	template <typename Base = Growth_golden>
+	struct
+	Growth_size_class
+	{
+		template <typename Alloc>
+		static
+		std::size_t
+		next(std::size_t size,
+					std::size_t n,
+					const Alloc& alloc)
+		{
+			return M_round(alloc, Base::next(size, n, alloc), 
+											type::has_good_size<Alloc>());
+		}
+		private:
+			template <typename Alloc>
+			static
+			std::size_t
+			M_round(const Alloc& alloc, 
+								std::size_t len, 
+								type::true_type)
+			{
+				const std::size_t good = alloc.good_size(len);
+				return (good < len ? len : good);
+			}
+			template <typename Alloc>
+			static
+			std::size_t
+			M_round(const Alloc&, 
+								std::size_t len, 
+								type::false_type)
+			{
+				return len;
+			}
+	};
+	
+	//---	
+	
+	// Normal iterator	
+	template <typename Iter,
+						typename Container>
+	class
+	Normal_iterator
+	{
+			typedef type::Iterator_traits<Iter>       Traits_type;
+			template <typename It>
+			using container_type_enable_if					= typename std::enable_if<(std::is_same<It,
+																									typename Container::pointer>::value),
+																									Container>::type;	
+		public:
+			using iterator_type											= Iter;		
+			using iterator_category									= typename Traits_type::iterator_category;
+			using value_type												= typename Traits_type::value_type;
+			using difference_type										= typename Traits_type::difference_type;
+			using reference													= typename Traits_type::reference;
+			using pointer														= typename Traits_type::pointer;	
+			
+			Normal_iterator()
+        : M_curr()
+      {
+      }
+      constexpr
+			Normal_iterator(const iterator_type& it) 
+				: M_curr(it) 
+			{ 
+			}
+			// Allow iterator to const_iterator conversion
+			template <typename I>
+			Normal_iterator(const Normal_iterator<I, container_type_enable_if<I>>& it)
+				: M_curr(it.base()) 
+			{ 
+			}
+			// Forward iterator requirements
+			reference
+			operator*() const
+			{
+				return *M_curr;
+			}
+			pointer
+			operator->() const
+			{
+				return &(operator*());
+			}																			
+			Normal_iterator&
+			operator++()
+			{ 
+				++M_curr;
+				return *this;
+			}
+			Normal_iterator
+			operator++(int)
+			{ 
+				return Normal_iterator(M_curr++);
+			}	
+			// Bidirectional iterator requirements		
+			Normal_iterator&
+			operator--()
+			{ 
+				--M_curr;
+				return *this;
+			}
+			Normal_iterator
+			operator--(int)
+			{ 
+				return Normal_iterator(M_curr--);
+			}	
+			// Random access iterator requirements
+			reference
+			operator[](const difference_type& n) const	
+			{
+				return M_curr[n];
+			}	
+			Normal_iterator&
+			operator+=(const difference_type& n)	
+			{
+				M_curr += n; 
+				return *this;
+			}	
+			Normal_iterator
+			operator+(const difference_type& n)	const
+			{
+				return Normal_iterator(M_curr + n);
+			}
+			Normal_iterator&
+			operator-=(const difference_type& n)	
+			{
+				M_curr -= n; 
+				return *this;
+			}	
+			Normal_iterator
+			operator-(const difference_type& n)	const
+			{
+				return Normal_iterator(M_curr - n);
+			}	
+			const Iter&
+			base() const
+			{
+				return M_curr;
+			}								
+		protected:
+			Iter M_curr{};
+			
+	};
+	// Forward iterator requirements
+	template <typename ItorL, 
+						typename ItorR, 
+						typename Container>
+	inline
+	bool
+	operator==(const Normal_iterator<ItorL, 
+																		Container>& lhs,
+							const Normal_iterator<ItorR, 
+																			Container>& rhs)
+	{
+		return (lhs.base() == rhs.base());
+	}
+	template <typename Itor, 
+						typename Container>
+	inline
+	bool
+	operator==(const Normal_iterator<Itor, 
+																		Container>& lhs,
+							const Normal_iterator<Itor, 
+																			Container>& rhs)
+	{
+		return (lhs.base() == rhs.base());
+	}
+	template <typename ItorL, 
+						typename ItorR, 
+						typename Container>
+	inline
+	bool
+	operator!=(const Normal_iterator<ItorL, 
+																		Container>& lhs,
+							const Normal_iterator<ItorR, 
+																			Container>& rhs)
+	{
+		return (!(lhs == rhs));
+	}
+	template <typename Itor, 
+						typename Container>
+	inline
+	bool
+	operator!=(const Normal_iterator<Itor, 
+																		Container>& lhs,
+							const Normal_iterator<Itor, 
+																			Container>& rhs)
+	{
+		return  (!(lhs == rhs));
+	}
+	// Random access iterator requirements	
+	template <typename IteratorL, 
+							typename IteratorR, 
+							typename Container>
+	inline 
+	bool
+	operator<(const Normal_iterator<IteratorL, Container>& lhs,
+							const Normal_iterator<IteratorR, Container>& rhs)
+	{ 
+		return lhs.base() < rhs.base(); 
+	}
+
+	template <typename Iterator, 
+							typename Container>
+	inline 
+	bool
+	operator<(const Normal_iterator<Iterator, Container>& lhs,
+							const Normal_iterator<Iterator, Container>& rhs)
+	{ 
+		return lhs.base() < rhs.base(); 
+	}
+
+	template <typename IteratorL, 
+							typename IteratorR, 
+							typename Container>
+	inline 
+	bool
+	operator>(const Normal_iterator<IteratorL, Container>& lhs,
+							const Normal_iterator<IteratorR, Container>& rhs)
+	{ 
+		return lhs.base() > rhs.base(); 
+	}
+
+	template <typename Iterator, 
+							typename Container>
+	inline 
+	bool
+	operator>(const Normal_iterator<Iterator, Container>& lhs,
+							const Normal_iterator<Iterator, Container>& rhs)
+	{ 
+		return lhs.base() > rhs.base(); 
+	}
+
+	template <typename IteratorL, 
+							typename IteratorR, 
+							typename Container>
+	inline 
+	bool
+	operator<=(const Normal_iterator<IteratorL, Container>& lhs,
+							const Normal_iterator<IteratorR, Container>& rhs)
+	{ 
+		return lhs.base() <= rhs.base(); 
+	}
+
+	template <typename Iterator, 
+							typename Container>
+	inline 
+	bool
+	operator<=(const Normal_iterator<Iterator, Container>& lhs,
+							const Normal_iterator<Iterator, Container>& rhs)
+	{ 
+		return lhs.base() <= rhs.base(); 
+	}
+
+	template <typename IteratorL, 
+							typename IteratorR, 
+							typename Container>
+	inline 
+	bool
+	operator>=(const Normal_iterator<IteratorL, Container>& lhs,
+							const Normal_iterator<IteratorR, Container>& rhs)
+	{ 
+		return lhs.base() >= rhs.base(); 
+	}
+
+	template <typename Iterator, 
+							typename Container>
+	inline 
+	bool
+	operator>=(const Normal_iterator<Iterator, Container>& lhs,
+							const Normal_iterator<Iterator, Container>& rhs)
+	{ 
+		return lhs.base() >= rhs.base(); 
+	}
+	
+	//
+	template <typename IteratorL, 
+							typename IteratorR, 
+							typename Container>
+	inline 
+	typename Normal_iterator<IteratorL, Container>::difference_type
+	operator-(const Normal_iterator<IteratorL, Container>& lhs,
+						const Normal_iterator<IteratorR, Container>& rhs)
+	{
+		return lhs.base() - rhs.base(); 
+	}
+	
+	template <typename Iterator, 
+							typename Container>
+	inline 
+	typename Normal_iterator<Iterator, Container>::difference_type
+	operator-(const Normal_iterator<Iterator, Container>& lhs,
+						const Normal_iterator<Iterator, Container>& rhs)
+	{
+		return lhs.base() - rhs.base(); 
+	}
+	template<typename Iterator, 
+						typename Container>
+	inline 
+	Normal_iterator<Iterator, Container>
+	operator+(typename Normal_iterator<Iterator, Container>::difference_type n,
+							const Normal_iterator<Iterator, Container>& i)
+	{
+		return Normal_iterator<Iterator, Container>(i.base() + n);
+	}
+	// Segment iterator
+	// Position in a container whose elements are spread over segments,
+	// random access but not contiguous. Container is const for the
+	// const iterator and provides operator[].
+	template <typename Container, 
+							typename Value>
+	class
+	Segment_iterator
+	{
+		public:
+			using iterator_category									= type::random_access_iterator_tag;
+			using value_type												= typename std::remove_const<Value>::type;
+			using difference_type										= std::ptrdiff_t;
+			using reference													= Value&;
+			using pointer														= Value*;
+
+			Segment_iterator() 
+				: M_cont(0), M_index(0)
+			{ 
+			}
+			Segment_iterator(Container* c, 
+												std::size_t i) 
+				: M_cont(c), M_index(i)
+			{ 
+			}
+			// Allow iterator to const_iterator conversion
+			template <typename C, 
+									typename V>
+			Segment_iterator(const Segment_iterator<C, V>& it)
+				: M_cont(it.container()), M_index(it.base())
+			{
+			}
+			// Forward iterator requirements
+			reference
+			operator*() const
+			{
+				return (*M_cont)[M_index];
+			}
+			pointer
+			operator->() const
+			{
+				return std::addressof((*M_cont)[M_index]);
+			}
+			Segment_iterator&
+			operator++()
+			{
+				++M_index;
+				return *this;
+			}
+			Segment_iterator
+			operator++(int)
+			{
+				return Segment_iterator(M_cont, M_index++);
+			}
+			// Bidirectional iterator requirements
+			Segment_iterator&
+			operator--()
+			{
+				--M_index;
+				return *this;
+			}
+			Segment_iterator
+			operator--(int)
+			{
+				return Segment_iterator(M_cont, M_index--);
+			}
+			// Random access iterator requirements
+			reference
+			operator[](const difference_type& n) const
+			{
+				return (*M_cont)[M_index + n];
+			}
+			Segment_iterator&
+			operator+=(const difference_type& n)
+			{
+				M_index += n;
+				return *this;
+			}
+			Segment_iterator
+			operator+(const difference_type& n) const
+			{
+				return Segment_iterator(M_cont, M_index + n);
+			}
+			Segment_iterator&
+			operator-=(const difference_type& n)
+			{
+				M_index -= n;
+				return *this;
+			}
+			Segment_iterator
+			operator-(const difference_type& n) const
+			{
+				return Segment_iterator(M_cont, M_index - n);
+			}
+			std::size_t
+			base() const
+			{
+				return M_index;
+			}
+			Container*
+			container() const
+			{
+				return M_cont;
+			}
+		protected:
+			Container* M_cont;
+			std::size_t M_index;
+	};
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator==(const Segment_iterator<CL, VL>& lhs,
+							const Segment_iterator<CR, VR>& rhs)
+	{
+		return (lhs.base() == rhs.base());
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator!=(const Segment_iterator<CL, VL>& lhs,
+							const Segment_iterator<CR, VR>& rhs)
+	{
+		return (!(lhs == rhs));
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator<(const Segment_iterator<CL, VL>& lhs,
+						const Segment_iterator<CR, VR>& rhs)
+	{
+		return (lhs.base() < rhs.base());
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator>(const Segment_iterator<CL, VL>& lhs,
+						const Segment_iterator<CR, VR>& rhs)
+	{
+		return (rhs < lhs);
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator<=(const Segment_iterator<CL, VL>& lhs,
+							const Segment_iterator<CR, VR>& rhs)
+	{
+		return (!(rhs < lhs));
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	bool
+	operator>=(const Segment_iterator<CL, VL>& lhs,
+							const Segment_iterator<CR, VR>& rhs)
+	{
+		return (!(lhs < rhs));
+	}
+	template <typename CL, 
+							typename VL, 
+							typename CR, 
+							typename VR>
+	inline
+	std::ptrdiff_t
+	operator-(const Segment_iterator<CL, VL>& lhs,
+						const Segment_iterator<CR, VR>& rhs)
+	{
+		return std::ptrdiff_t(lhs.base() - rhs.base());
+	}
+	template <typename Container, 
+							typename Value>
+	inline
+	Segment_iterator<Container, Value>
+	operator+(std::ptrdiff_t n,
+						const Segment_iterator<Container, Value>& i)
+	{
+		return (i + n);
+	}
+		// Reverse iterator
+	template <typename Iter>
+	class
+	Reverse_iterator
+	{
+			typedef type::Iterator_traits<Iter>       Traits_type;	
+		public:
+			using iterator_type											= Iter;		
+			// A reversed range is random access at best, never contiguous
+			using iterator_category									= typename std::conditional<
+																									bool(type::is_contiguous_iterator<Iter>{}),
+																									type::random_access_iterator_tag,
+																									typename Traits_type::iterator_category>::type;
+			using value_type												= typename Traits_type::value_type;
+			using difference_type										= typename Traits_type::difference_type;
+			using reference													= typename Traits_type::reference;
+			using pointer														= typename Traits_type::pointer;	
+			
+			Reverse_iterator() 
+				: M_curr() 
+			{ 
+			}
+			explicit
+			Reverse_iterator(iterator_type it) 
+				: M_curr(it) 
+			{ 
+			}
+			template <typename I>
+			Reverse_iterator(const Reverse_iterator<I>& it)
+				: M_curr(it.base())
+			{			
+			}
+			iterator_type
+			base() const
+			{
+				return M_curr;
+			}
+			reference
+			operator*() const
+			{
+				Iter tmp{M_curr};
+				return (*--tmp);
+			}
+			pointer
+			operator->() const
+			{
+				return &(operator*());
+			}
+			Reverse_iterator&
+			operator++()
+			{
+				--M_curr;
+				return *this;
+			}
+			Reverse_iterator
+			operator++(int)
+			{
+				Reverse_iterator tmp = *this;
+				--M_curr;
+				return tmp;
+			}
+			Reverse_iterator&
+			operator--()
+			{
+				++M_curr;
+				return *this;
+			}
+			Reverse_iterator
+			operator--(int)
+			{
+				Reverse_iterator tmp = *this;
+				++M_curr;
+				return tmp;
+			}	
+			Reverse_iterator
+			operator+(difference_type n) const
+			{
+				return Reverse_iterator(M_curr - n);
+			}	
+			Reverse_iterator&
+			operator+=(difference_type n)	
+			{
+				M_curr -= n;
+				return *this;
+			}
+			Reverse_iterator
+			operator-(difference_type n) const
+			{
+				return Reverse_iterator(M_curr + n);
+			}	
+			Reverse_iterator&
+			operator-=(difference_type n)	
+			{
+				M_curr += n;
+				return *this;
+			}
+			reference
+			operator[](difference_type n) const		
+			{
+				return *(*this + n);
+			}	
+		protected:
+			Iter M_curr{};	
+	};
+	template<typename Iter>
+	inline
+	bool
+	operator==(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (lhs.base() == rhs.base());
+	}
+	template<typename Iter>
+	inline
+	bool
+	operator!=(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (!(lhs == rhs));
+	}
+	template<typename Iter>
+	inline
+	bool
+	operator<(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (rhs.base() < lhs.base());
+	}
+	template<typename Iter>
+	inline
+	bool
+	operator>(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (rhs < lhs);
+	}	
+	template<typename Iter>
+	inline
+	bool
+	operator<=(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (!(rhs < lhs));
+	}
+	template<typename Iter>
+	inline
+	bool
+	operator>=(const Reverse_iterator<Iter>& lhs,
+							const Reverse_iterator<Iter>& rhs)
+	{
+		return (!(lhs < rhs));
+	}		
+	//---
+	// Iterator operations
+	template <typename InputIterator>
+	typename type::Iterator_traits<InputIterator>::difference_type
+	distance(InputIterator first,
+						InputIterator last,
+						type::input_iterator_tag)
+	{
+		typename type::Iterator_traits<InputIterator>::difference_type n = 0;
+		for (; first != last; ++first)
+			++n;
+		return n;
+	}
+	template <typename RandomAccessIterator>
+	typename type::Iterator_traits<RandomAccessIterator>::difference_type
+	distance(RandomAccessIterator first,
+						RandomAccessIterator last,
+						type::random_access_iterator_tag)
+	{
+		return (last - first);
+	}
+	template <typename InputIterator>
+	inline
+	typename type::Iterator_traits<InputIterator>::difference_type
+	distance(InputIterator first,
+						InputIterator last)
+	{
+		typedef typename type::Iterator_traits<InputIterator>::iterator_category
+		IterCategory;
+		return lib_impl::distance(first, last, IterCategory());
+	}
+	template <typename InputIterator, 
+						typename Distance>
+	void
+	advance(InputIterator& it,
+					Distance n,
+					type::input_iterator_tag)
+	{
+		for (; n > 0; --n)
+			++it;
+	}
+	template <typename RandomAccessIterator, 
+						typename Distance>
+	void
+	advance(RandomAccessIterator& it,
+					Distance n,
+					type::random_access_iterator_tag)
+	{
+		it += n;
+	}
+	template <typename InputIterator, 
+						typename Distance>
+	inline
+	void
+	advance(InputIterator& it,
+					Distance n)
+	{
+		typedef typename type::Iterator_traits<InputIterator>::iterator_category
+		IterCategory;
+		lib_impl::advance(it, n, IterCategory());
+	}
+	//---
+	// Trivial kernels
+	// Ranges of trivially copyable elements behind raw pointers are
+	// copied with memcpy/memmove and filled with memset.
+	// The allocators construct with placement new, so for these types
+	// the bytes are the objects.
+	// Normal_iterator is contiguous over a pointer and is unwrapped 
+	// to it first.
+	template<typename Iterator>
+	inline
+	Iterator
+	niter_base(Iterator it)
+	{
+		return it;
+	}
+	template<typename Iter, 
+						typename Container>
+	inline
+	Iter
+	niter_base(Normal_iterator<Iter, Container> it)
+	{
+		return it.base();
+	}
+	// Result pointer back into the iterator type of the caller
+	template<typename Iterator>
+	inline
+	Iterator
+	niter_wrap(Iterator, 
+							Iterator res)
+	{
+		return res;
+	}
+	template<typename Iter, 
+						typename Container>
+	inline
+	Normal_iterator<Iter, Container>
+	niter_wrap(Normal_iterator<Iter, Container>, 
+							Iter res)
+	{
+		return Normal_iterator<Iter, Container>(res);
+	}
+	// Elements of InputIterator can be copied as bytes to OutputIterator
+	template<typename InputIterator, 
+						typename OutputIterator>
+	struct
+	Use_memmove
+		: public type::false_type
+	{
+	};
+	template<typename T, 
+						typename U>
+	struct
+	Use_memmove<T*, U*>
+		: public type::__bool_constant<std::is_same<typename std::remove_const<T>::type, U>::value
+																		&& std::is_trivially_copyable<U>::value>
+	{
+	};
+	// Elements of OutputIterator can be set with memset
+	template<typename OutputIterator>
+	struct
+	Use_memset
+		: public type::false_type
+	{
+	};
+	template<typename T>
+	struct
+	Use_memset<T*>
+		: public type::__bool_constant<std::is_scalar<T>::value>
+	{
+	};
+	// The byte repeated by all bytes of val, if there is one
+	template<typename T>
+	inline
+	bool
+	memset_byte(const T& val, 
+								unsigned char& byte)
+	{
+		unsigned char bytes[sizeof(T)];
+		std::memcpy(bytes, std::addressof(val), sizeof(T));
+		byte = bytes[0];
+		for (std::size_t i = 1; i != sizeof(T); ++i)
+		{
+			if (bytes[i] != byte)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	template<typename T, 
+						typename Size>
+	inline
+	T*
+	fill_n_trivial(T* first, 
+									Size n, 
+									const T& val)
+	{
+		unsigned char byte;
+		if (n > 0 && memset_byte(val, byte))
+		{
+			std::memset(first, byte, std::size_t(n) * sizeof(T));
+			return first + n;
+		}
+		for (; n > 0; --n, ++first)
+		{
+			*first = val;
+		}
+		return first;
+	}
+	//---
+	// SIMD kernels
+	// Index of the first element where a and b differ, n when all equal.
+	// Integers are compared as bytes, the first differing byte lies in the
+	// first differing element. float and double lanes compare with ==,
+	// so -0.0 equals 0.0 and NaN equals nothing, like the scalar loop.
+	// SSE2 is always there on x86-64, AVX2 is used when the CPU has it,
+	// the kernels are chosen once at run time.
+	class
+	Simd
+	{
+		public:
+			static
+			std::size_t
+			mismatch(const unsigned char* a, 
+								const unsigned char* b, 
+								std::size_t n)
+			{
+				return M_kernels().bytes(a, b, n);
+			}
+			static
+			std::size_t
+			mismatch(const float* a, 
+								const float* b, 
+								std::size_t n)
+			{
+				return M_kernels().floats(a, b, n);
+			}
+			static
+			std::size_t
+			mismatch(const double* a, 
+								const double* b, 
+								std::size_t n)
+			{
+				return M_kernels().doubles(a, b, n);
+			}
+			// Name of the instruction set in use
+			static
+			const char*
+			isa()
+			{
+				return M_kernels().name;
+			}
+		private:
+			struct
+			Kernels
+			{
+				std::size_t (*bytes)(const unsigned char*, const unsigned char*, std::size_t);
+				std::size_t (*floats)(const float*, const float*, std::size_t);
+				std::size_t (*doubles)(const double*, const double*, std::size_t);
+				const char* name;
+			};
+			static
+			const Kernels&
+			M_kernels()
+			{
+				static const Kernels kernels = M_select();
+				return kernels;
+			}
+			static
+			Kernels
+			M_select()
+			{
+#if LIB_SIMD && (defined(__x86_64__) || defined(__i386__))
+				if (__builtin_cpu_supports("avx2"))
+				{
+					return Kernels{&M_bytes_avx2, &M_floats_avx2, &M_doubles_avx2, "avx2"};
+				}
+				if (__builtin_cpu_supports("sse2"))
+				{
+					return Kernels{&M_bytes_sse2, &M_floats_sse2, &M_doubles_sse2, "sse2"};
+				}
+#endif
+				return Kernels{&M_scalar<unsigned char>, &M_scalar<float>, &M_scalar<double>, "scalar"};
+			}
+			template <typename T>
+			static
+			std::size_t
+			M_scalar(const T* a, 
+								const T* b, 
+								std::size_t n)
+			{
+				std::size_t i = 0;
+				while (i != n && a[i] == b[i])
+				{
+					++i;
+				}
+				return i;
+			}
+#if LIB_SIMD && (defined(__x86_64__) || defined(__i386__))
+			_Target_sse2
+			static
+			std::size_t
+			M_bytes_sse2(const unsigned char* a, 
+										const unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+					const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+					const unsigned mask = ~unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xFFFFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_bytes_avx2(const unsigned char* a, 
+										const unsigned char* b, 
+										std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 32 <= n; i += 32)
+				{
+					const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+					const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+					const unsigned mask = ~unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_bytes_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			std::size_t
+			M_floats_sse2(const float* a, 
+											const float* b, 
+											std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const unsigned mask = ~unsigned(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), 
+																																				_mm_loadu_ps(b + i)))) & 0xFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_floats_avx2(const float* a, 
+											const float* b, 
+											std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const unsigned mask = ~unsigned(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), 
+																																						_mm256_loadu_ps(b + i),
+																																						_CMP_EQ_OQ))) & 0xFFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_floats_sse2(a + i, b + i, n - i);
+			}
+			_Target_sse2
+			static
+			std::size_t
+			M_doubles_sse2(const double* a, 
+												const double* b, 
+												std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 2 <= n; i += 2)
+				{
+					const unsigned mask = ~unsigned(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), 
+																																				_mm_loadu_pd(b + i)))) & 0x3u;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_scalar(a + i, b + i, n - i);
+			}
+			_Target_avx2
+			static
+			std::size_t
+			M_doubles_avx2(const double* a, 
+												const double* b, 
+												std::size_t n)
+			{
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const unsigned mask = ~unsigned(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), 
+																																						_mm256_loadu_pd(b + i),
+																																						_CMP_EQ_OQ))) & 0xFu;
+					if (mask)
+					{
+						return i + __builtin_ctz(mask);
+					}
+				}
+				return i + M_doubles_sse2(a + i, b + i, n - i);
+			}
+#endif
+	};
+	// Index of the first mismatch of [a, a + n) and [b, b + n)
+	template <typename T>
+	inline
+	std::size_t
+	simd_mismatch(const T* a, 
+									const T* b, 
+									std::size_t n)
+	{
+		// integers compare equal exactly when their bytes do
+		return Simd::mismatch(reinterpret_cast<const unsigned char*>(a), 
+													reinterpret_cast<const unsigned char*>(b), 
+													n * sizeof(T)) / sizeof(T);
+	}
+	inline
+	std::size_t
+	simd_mismatch(const float* a, 
+									const float* b, 
+									std::size_t n)
+	{
+		return Simd::mismatch(a, b, n);
+	}
+	inline
+	std::size_t
+	simd_mismatch(const double* a, 
+									const double* b, 
+									std::size_t n)
+	{
+		return Simd::mismatch(a, b, n);
+	}
+	// Element types the SIMD kernels compare
+	template <typename Iterator>
+	struct
+	Use_simd_compare
+		: public type::false_type
+	{
+	};
+	template <typename T>
+	struct
+	Use_simd_compare<T*>
+		: public type::__bool_constant<std::is_integral<typename std::remove_const<T>::type>::value
+																		|| std::is_same<typename std::remove_const<T>::type, float>::value
+																		|| std::is_same<typename std::remove_const<T>::type, double>::value>
+	{
+	};
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	equal(Iter1 first1, 
+				Iter1 last1, 
+				Iter2 first2, 
+				type::false_type)
+	{
+		return std::equal(first1, last1, first2);
+	}
+	template <typename T>
+	inline
+	bool
+	equal(const T* first1, 
+				const T* last1, 
+				const T* first2, 
+				type::true_type)
+	{
+		const std::size_t n = last1 - first1;
+		return (simd_mismatch(first1, first2, n) == n);
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	lexicographical_compare(Iter1 first1, 
+													Iter1 last1, 
+													Iter2 first2, 
+													Iter2 last2,
+													type::false_type)
+	{
+		return std::lexicographical_compare(first1, last1, first2, last2);
+	}
+	// Skips to each mismatch, elements neither less nor greater (NaN) 
+	// are passed over like in the scalar loop
+	template <typename T>
+	inline
+	bool
+	lexicographical_compare(const T* first1, 
+													const T* last1, 
+													const T* first2, 
+													const T* last2,
+													type::true_type)
+	{
+		const std::size_t n1 = last1 - first1;
+		const std::size_t n2 = last2 - first2;
+		const std::size_t n = (n1 < n2 ? n1 : n2);
+		std::size_t i = simd_mismatch(first1, first2, n);
+		while (i != n)
+		{
+			if (first1[i] < first2[i])
+			{
+				return true;
+			}
+			if (first2[i] < first1[i])
+			{
+				return false;
+			}
+			++i;
+			i += simd_mismatch(first1 + i, first2 + i, n - i);
+		}
+		return (n1 < n2);
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	equal(Iter1 first1, 
+				Iter1 last1, 
+				Iter2 first2)
+	{
+		typedef decltype(niter_base(first1)) Ptr1;
+		typedef decltype(niter_base(first2)) Ptr2;
+		return lib_impl::equal(niter_base(first1), niter_base(last1), niter_base(first2),
+														type::__bool_constant<bool(Use_simd_compare<Ptr1>{})
+																									&& std::is_same<Ptr1, Ptr2>::value>());
+	}
+	template <typename Iter1, 
+						typename Iter2>
+	inline
+	bool
+	lexicographical_compare(Iter1 first1, 
+													Iter1 last1, 
+													Iter2 first2, 
+													Iter2 last2)
+	{
+		typedef decltype(niter_base(first1)) Ptr1;
+		typedef decltype(niter_base(first2)) Ptr2;
+		return lib_impl::lexicographical_compare(niter_base(first1), niter_base(last1), 
+																							niter_base(first2), niter_base(last2),
+																							type::__bool_constant<bool(Use_simd_compare<Ptr1>{})
+																																		&& std::is_same<Ptr1, Ptr2>::value>());
+	}
+	//---
+	// Initialization helpers
+	template<class InputIterator, 
+					class A>
+	void 
+	destroy_a(InputIterator first, 
+							InputIterator last, 
+							A alloc,
+							type::false_type)
+	noexcept(true)
+	{
+		for (; first != last; ++first)
+			alloc.destroy(std::addressof(*first));	
+	}	
+	// Nothing to run for trivially destructible elements
+	template<class InputIterator, 
+					class A>
+	void 
+	destroy_a(InputIterator, 
+							InputIterator, 
+							A,
+							type::true_type)
+	noexcept(true)
+	{
+	}	
+	template<class InputIterator, 
+					class A>
+	void 
+	destroy_a(InputIterator first, 
+							InputIterator last, 
+							A alloc)
+	noexcept(true)
+	{
+		typedef 
+		typename type::Iterator_traits<InputIterator>::value_type
+		ValueType;
+		destroy_a(first, last, alloc, 
+							type::__bool_constant<std::is_trivially_destructible<ValueType>::value>());
+	}	
+		
+	template<class InputIterator, 
+					class A>
+	void 
+	uninitialized_fill_a(InputIterator first, 
+												InputIterator last, 
+												A alloc)
+	noexcept(false)
+	{
+		typedef 
+		typename type::Iterator_traits<InputIterator>::value_type
+		ValueType;
+		
+		InputIterator current = first;
+		try
+		{
+			for (; current != last; ++current)
+				alloc.construct(std::addressof(*current), ValueType());
+		}
+		catch(...)
+		{
+			//for (; first != current; ++first)
+			//	alloc.destroy(std::addressof(*first));
+			destroy_a(first,current,alloc);
+			throw std::runtime_error{"Default initialization failed"};			
+		}
+	}
+	
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename T,
+						typename A>
+	void
+	uninitialized_fill_n_a(ForwardIterator first, 
+													Size n,
+													const T& val, 
+													A&,
+													type::true_type)
+	{
+		typedef 
+		typename type::Iterator_traits<ForwardIterator>::value_type
+		ValueType;
+		const ValueType v = val;
+		fill_n_trivial(first, n, v);
+	}
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename T,
+						typename A>
+	void
+	uninitialized_fill_n_a(ForwardIterator first, 
+													Size n,
+													const T& val, 
+													A& alloc,
+													type::false_type)
+	{
+		ForwardIterator curr = first;
+		try
+		{
+			for (; n > 0; --n, ++curr)
+			{
+				alloc.construct(std::addressof(*curr), val);
+			}
+		}
+		catch(...)
+		{
+			destroy_a(first, curr, alloc);
+			throw std::runtime_error{"Default initialization failed"};						
+		}
+	}
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename T,
+						typename A>
+	void
+	uninitialized_fill_n_a(ForwardIterator first, 
+													Size n,
+													const T& val, 
+													A& alloc)
+	{
+		uninitialized_fill_n_a(niter_base(first), n, val, alloc, 
+														Use_memset<decltype(niter_base(first))>());
+	}
+	
+	// Default initialization, trivial elements are left uninitialized
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename A>
+	ForwardIterator
+	uninitialized_default_n_a(ForwardIterator first, 
+														Size n,
+														A&,
+														type::true_type)
+	{
+		lib_impl::advance(first, n);
+		return first;
+	}
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename A>
+	ForwardIterator
+	uninitialized_default_n_a(ForwardIterator first, 
+														Size n,
+														A& alloc,
+														type::false_type)
+	{
+		typedef 
+		typename type::Iterator_traits<ForwardIterator>::value_type
+		ValueType;
+
+		ForwardIterator curr = first;
+		try
+		{
+			for (; n > 0; --n, ++curr)
+			{
+				::new( static_cast<void*>(std::addressof(*curr)) ) ValueType;
+			}
+			return curr;
+		}
+		catch(...)
+		{
+			destroy_a(first, curr, alloc);
+			throw std::runtime_error{"Default initialization failed"};						
+		}
+	}
+	template<typename ForwardIterator, 
+						typename Size, 
+						typename A>
+	ForwardIterator
+	uninitialized_default_n_a(ForwardIterator first, 
+														Size n,
+														A& alloc)
+	{
+		typedef 
+		typename type::Iterator_traits<ForwardIterator>::value_type
+		ValueType;
+		return uninitialized_default_n_a(first, n, alloc,
+																			type::__bool_constant<
+																				std::is_trivially_default_constructible<ValueType>::value>());
+	}
+
+	template<class InputIterator,
+						class ForwardIterator, 
+						class A>
+	ForwardIterator 
+	uninitialized_copy_a(InputIterator first, 
+												InputIterator last,
+												ForwardIterator	result, 
+												A,
+												type::true_type)
+	noexcept(false)
+	{
+		const std::ptrdiff_t n = last - first;
+		if (n > 0)
+		{
+			std::memcpy(result, first, std::size_t(n) * sizeof(*result));
+		}
+		return result + n;
+	}
+	template<class InputIterator,
+						class ForwardIterator, 
+						class A>
+	ForwardIterator 
+	uninitialized_copy_a(InputIterator first, 
+												InputIterator last,
+												ForwardIterator	result, 
+												A alloc,
+												type::false_type)
+	noexcept(false)
+	{
+		ForwardIterator curr{result};
+		try
+		{
+			for (; first != last; ++first, ++curr)
+			{
+				alloc.construct(std::addressof(*curr), *first);
+			}
+			return curr;
+		}
+		catch(...)
+		{
+			destroy_a(result, curr, alloc);
+			throw std::runtime_error{"Copy initialization failed"};						
+		}
+	
+	}
+	template<class InputIterator,
+						class ForwardIterator, 
+						class A>
+	ForwardIterator 
+	uninitialized_copy_a(InputIterator first, 
+												InputIterator last,
+												ForwardIterator	result, 
+												A alloc)
+	noexcept(false)
+	{
+		return niter_wrap(result, 
+											uninitialized_copy_a(niter_base(first), 
+																						niter_base(last), 
+																						niter_base(result), 
+																						alloc,
+																						Use_memmove<decltype(niter_base(first)), 
+																												decltype(niter_base(result))>()));
+	}
+	
+	template<typename InputIterator, 
+						typename ForwardIterator>
+	ForwardIterator
+	copy(InputIterator first, 
+	 			InputIterator last,
+	 			ForwardIterator result,
+	 			type::false_type)
+	{
+	 	for (; first != last; (void)++first, (void)++result)
+	 	{
+	 		*result = *first;
+	 	}
+	 	return result;
+	}
+	// Ranges may overlap
+	template<typename InputIterator, 
+						typename ForwardIterator>
+	ForwardIterator
+	copy(InputIterator first, 
+	 			InputIterator last,
+	 			ForwardIterator result,
+	 			type::true_type)
+	{
+		const std::ptrdiff_t n = last - first;
+		if (n > 0)
+		{
+			std::memmove(result, first, std::size_t(n) * sizeof(*result));
+		}
+		return result + n;
+	}
+	template<typename InputIterator, 
+						typename ForwardIterator>
+	ForwardIterator
+	copy(InputIterator first, 
+	 			InputIterator last,
+	 			ForwardIterator result)
+	{
+		return niter_wrap(result, 
+											lib_impl::copy(niter_base(first), 
+																			niter_base(last), 
+																			niter_base(result),
+																			Use_memmove<decltype(niter_base(first)), 
+																									decltype(niter_base(result))>()));
+	}
+	
+	template<typename OutputIt, 
+						typename Size, 
+						typename T>		
+	OutputIt 
+	fill_n(OutputIt result, 
+					Size count, 
+					const T& val,
+					type::false_type)
+	{
+		for (Size i = 0; i < count; i++)
+			*result++ = val;
+		return result;
+	}
+	template<typename OutputIt, 
+						typename Size, 
+						typename T>		
+	OutputIt 
+	fill_n(OutputIt result, 
+					Size count, 
+					const T& val,
+					type::true_type)
+	{
+		typedef 
+		typename type::Iterator_traits<OutputIt>::value_type
+		ValueType;
+		const ValueType v = val;
+		return fill_n_trivial(result, count, v);
+	}
+	template<typename OutputIt, 
+						typename Size, 
+						typename T>		
+	OutputIt 
+	fill_n(OutputIt result, 
+					Size count, 
+					const T& val)
+	{
+		return niter_wrap(result, 
+											lib_impl::fill_n(niter_base(result), count, val, 
+																				Use_memset<decltype(niter_base(result))>()));
+	}
+	
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move(InputIterator first, 
+				InputIterator last,
+				OutputIterator result,
+				type::false_type)
+	{
+		for (; first != last; (void)++first, (void)++result)
+		{
+			*result = std::move(*first);
+		}
+		return result;
+	}
+	// Ranges may overlap
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move(InputIterator first, 
+				InputIterator last,
+				OutputIterator result,
+				type::true_type)
+	{
+		return lib_impl::copy(first, last, result, type::true_type());
+	}
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move(InputIterator first, 
+				InputIterator last,
+				OutputIterator result)
+	{
+		return niter_wrap(result, 
+											lib_impl::move(niter_base(first), 
+																			niter_base(last), 
+																			niter_base(result),
+																			Use_memmove<decltype(niter_base(first)), 
+																									decltype(niter_base(result))>()));
+	}
+	
+	template<typename ForwardIt, 
+						typename T>
+	void 
+	fill(ForwardIt first, 
+				ForwardIt last, 
+				const T& val,
+				type::forward_iterator_tag)
+	{
+		for (; first != last; ++first)
+		{
+			*first = val;
+		}
+	}
+	template<typename RandomAccessIterator, 
+						typename T>
+	void 
+	fill(RandomAccessIterator first, 
+				RandomAccessIterator last, 
+				const T& val,
+				type::random_access_iterator_tag)
+	{
+		lib_impl::fill_n(first, last - first, val);
+	}
+	template<typename ForwardIt, 
+						typename T>
+	void 
+	fill(ForwardIt first, 
+				ForwardIt last, 
+				const T& val)
+	{
+		typedef typename type::Iterator_traits<ForwardIt>::iterator_category
+		IterCategory;
+		lib_impl::fill(first, last, val, IterCategory());
+	}
+	
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move_backward(InputIterator first, 
+									InputIterator last,
+									OutputIterator result,
+									type::false_type)
+	{
+		while (first != last)
+		{
+			*(--result) = std::move(*(--last));
+		}
+		return result;
+	}
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move_backward(InputIterator first, 
+									InputIterator last,
+									OutputIterator result,
+									type::true_type)
+	{
+		const std::ptrdiff_t n = last - first;
+		if (n > 0)
+		{
+			std::memmove(result - n, first, std::size_t(n) * sizeof(*result));
+		}
+		return result - n;
+	}
+	template <typename InputIterator, 
+							typename OutputIterator>	
+	OutputIterator
+	move_backward(InputIterator first, 
+									InputIterator last,
+									OutputIterator result)
+	{
+		return niter_wrap(result, 
+											lib_impl::move_backward(niter_base(first), 
+																							niter_base(last), 
+																							niter_base(result),
+																							Use_memmove<decltype(niter_base(first)), 
+																													decltype(niter_base(result))>()));
+	}
+	
+	template <typename InputIt, 
+							typename NoThrowForwardIt,
+							typename	Alloc>
+	NoThrowForwardIt 
+	uninitialized_move_a(InputIt first, 
+											InputIt last, 
+											NoThrowForwardIt d_first,
+											Alloc a)
+	{
+		NoThrowForwardIt current = d_first;
+		try
+		{
+			for (; first != last; ++first, (void) ++current) 
+			{
+				a.construct(current, std::move(*first));
+			}
+			return current;
+		}
+		catch(...)
+		{
+			destroy_a(d_first, current,a);
+			throw std::runtime_error{"Move initialization failed"};						
+		}
+	}
+	template <typename InputIt, 
+							typename NoThrowForwardIt,
+							typename	Alloc>
+	NoThrowForwardIt 
+	uninitialized_move_if_noexcept_a(InputIt first, 
+																		InputIt last, 
+																		NoThrowForwardIt d_first,
+																		Alloc& a)
+	{
+		NoThrowForwardIt current = d_first;
+		try
+		{
+			for (; first != last; ++first, (void) ++current) 
+			{
+				// copy when the move constructor may throw
+				// so the source range is left untouched on failure
+				a.construct(current, std::move_if_noexcept(*first));
+			}
+			return current;
+		}
+		catch(...)
+		{
+			destroy_a(d_first, current,a);
+			throw std::runtime_error{"Move initialization failed"};						
+		}
+	}
+	// Relocation helpers
+	// Trivially relocatable elements are moved as a single block of bytes
+	// and the source storage is released without running destructors.
+	// Other elements are moved when their move constructor is noexcept
+	// and copied otherwise, which keeps the strong exception guarantee.
+	template <typename T,
+							typename A>
+	T*
+	uninitialized_relocate_a(T* first,
+														T* last,
+														T* result,
+														A& alloc,
+														type::true_type)
+	noexcept(true)
+	{
+		static_cast<void>(alloc);
+		const std::ptrdiff_t n = last - first;
+		if (n > 0)
+		{
+			std::memcpy(static_cast<void*>(result),
+										static_cast<const void*>(first),
+										n * sizeof(T));
+		}
+		return result + n;
+	}
+	template <typename T,
+							typename A>
+	T*
+	uninitialized_relocate_a(T* first,
+														T* last,
+														T* result,
+														A& alloc,
+														type::false_type)
+	{
+		return uninitialized_move_if_noexcept_a(first, last, result, alloc);
+	}
+	template <typename T,
+							typename A>
+	T*
+	uninitialized_relocate_a(T* first,
+														T* last,
+														T* result,
+														A& alloc)
+	{
+		return uninitialized_relocate_a(first, last, result, alloc,
+																			type::is_trivially_relocatable<T>());
+	}
+	template <typename T,
+							typename A>
+	void
+	destroy_relocated_a(T*,
+												T*,
+												A&,
+												type::true_type)
+	noexcept(true)
+	{
+		// bytes already owned by the new storage
+	}
+	template <typename T,
+							typename A>
+	void
+	destroy_relocated_a(T* first,
+												T* last,
+												A& alloc,
+												type::false_type)
+	noexcept(true)
+	{
+		destroy_a(first, last, alloc);
+	}
+	template <typename T,
+							typename A>
+	void
+	destroy_relocated_a(T* first,
+												T* last,
+												A& alloc)
+	noexcept(true)
+	{
+		destroy_relocated_a(first, last, alloc,
+													type::is_trivially_relocatable<T>());
+	}
+	// Thread pool
+	// A fixed set of workers, started on first use and pinned one per
+	// allowed CPU (LIB_PIN=0 leaves them floating). LIB_THREADS sets the
+	// concurrency, else the hardware threads; the workers are one less,
+	// at least one, the thread joining a Fork_join being the last.
+	// Each worker has its own deque of tasks: it pushes and pops at the
+	// back and, when empty, steals from the front of the others.
+	// Threads outside the pool submit round robin.
+	// Tasks are intrusive nodes owned by the submitter, which may take
+	// back the ones not yet started.
+	class
+	Thread_pool
+	{
+		public:
+			struct Queue;
+			struct
+			Task
+			{
+				void (*run)(Task*);
+				Task* prev;
+				Task* next;
+				Queue* queue;
+			};
+			struct
+			alignas(64)
+			Queue
+			{
+				std::mutex lock;
+				Task* head;
+				Task* tail;
+			};
+
+			static
+			Thread_pool&
+			instance()
+			{
+				static Thread_pool pool;
+				return pool;
+			}
+			// Workers
+			std::size_t
+			size() const
+			noexcept
+			{
+				return M_count;
+			}
+			// Threads a Fork_join may use
+			std::size_t
+			concurrency() const
+			noexcept
+			{
+				return M_concurrency;
+			}
+			void
+			submit(Task* t)
+			{
+				const std::size_t self = M_self;
+				Queue& q = M_queues[self < M_count ? self 
+																						: M_next.fetch_add(1, std::memory_order_relaxed) % M_count];
+				{
+					std::lock_guard<std::mutex> guard(q.lock);
+					t->queue = &q;
+					t->prev = q.tail;
+					t->next = 0;
+					(q.tail ? q.tail->next : q.head) = t;
+					q.tail = t;
+					M_queued.fetch_add(1);
+				}
+				if (M_sleeping.load() != 0)
+				{
+					std::lock_guard<std::mutex> guard(M_sleep_lock);
+					M_wake.notify_one();
+				}
+			}
+			// true when t was still queued and is now removed
+			bool
+			cancel(Task* t)
+			noexcept
+			{
+				Queue& q = *t->queue;
+				std::lock_guard<std::mutex> guard(q.lock);
+				if (t->prev == t)
+				{
+					// taken by a worker
+					return false;
+				}
+				M_unlink(q, t);
+				return true;
+			}
+			// Runs one queued task on the calling thread, own deque first
+			bool
+			run_one()
+			{
+				const std::size_t self = M_self;
+				Task* t = (self < M_count ? M_take(M_queues[self], true) : 0);
+				const std::size_t start = (self < M_count ? self 
+																									: M_next.load(std::memory_order_relaxed));
+				for (std::size_t i = 1; !t && i <= M_count; ++i)
+				{
+					t = M_take(M_queues[(start + i) % M_count], false);
+				}
+				if (!t)
+				{
+					return false;
+				}
+				t->run(t);
+				return true;
+			}
+			// Queued tasks still run before the workers exit
+			~Thread_pool()
+			{
+				{
+					std::lock_guard<std::mutex> guard(M_sleep_lock);
+					M_stop = true;
+				}
+				M_wake.notify_all();
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_threads[i].join();
+				}
+			}
+		private:
+			Thread_pool()
+				: M_concurrency(M_default_concurrency()), 
+					M_count(M_concurrency > 1 ? M_concurrency - 1 : 1),
+					M_queued(0), M_sleeping(0), M_next(0), M_stop(false)
+			{
+				M_queues.reset(new Queue[M_count]);
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_queues[i].head = 0;
+					M_queues[i].tail = 0;
+				}
+				M_threads.reset(new std::thread[M_count]);
+				for (std::size_t i = 0; i != M_count; ++i)
+				{
+					M_threads[i] = std::thread(&Thread_pool::M_work, this, i);
+				}
+			}
+			Thread_pool(const Thread_pool&) = delete;
+			Thread_pool& operator=(const Thread_pool&) = delete;
+
+			static
+			std::size_t
+			M_default_concurrency()
+			{
+				const char* env = std::getenv("LIB_THREADS");
+				if (env)
+				{
+					const long n = std::strtol(env, 0, 10);
+					return (n > 1 ? std::size_t(n) : 1);
+				}
+				const unsigned hw = std::thread::hardware_concurrency();
+				return (hw > 1 ? hw : 1);
+			}
+			// Worker i on the (i + 1)th allowed CPU, the first one is 
+			// left to the thread which started the pool
+			static
+			void
+			M_pin(std::size_t i)
+			noexcept
+			{
+#if defined(__linux__)
+				const char* env = std::getenv("LIB_PIN");
+				cpu_set_t allowed;
+				if ((env && std::strcmp(env, "0") == 0) 
+						|| sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+				{
+					return;
+				}
+				const int cpus = CPU_COUNT(&allowed);
+				int k = int((i + 1) % std::size_t(cpus));
+				for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+				{
+					if (CPU_ISSET(cpu, &allowed) && k-- == 0)
+					{
+						cpu_set_t one;
+						CPU_ZERO(&one);
+						CPU_SET(cpu, &one);
+						static_cast<void>(pthread_setaffinity_np(pthread_self(), sizeof(one), &one));
+						return;
+					}
+				}
+#else
+				static_cast<void>(i);
+#endif
+			}
+			// Marks t as taken, q locked
+			void
+			M_unlink(Queue& q, 
+								Task* t)
+			noexcept
+			{
+				(t->prev ? t->prev->next : q.head) = t->next;
+				(t->next ? t->next->prev : q.tail) = t->prev;
+				t->prev = t;
+				M_queued.fetch_sub(1);
+			}
+			Task*
+			M_take(Queue& q, 
+							bool back)
+			noexcept
+			{
+				std::lock_guard<std::mutex> guard(q.lock);
+				Task* t = (back ? q.tail : q.head);
+				if (t)
+				{
+					M_unlink(q, t);
+				}
+				return t;
+			}
+			void
+			M_work(std::size_t i)
+			{
+				M_self = i;
+				M_pin(i);
+				for (;;)
+				{
+					if (run_one())
+					{
+						continue;
+					}
+					std::unique_lock<std::mutex> guard(M_sleep_lock);
+					M_sleeping.fetch_add(1);
+					M_wake.wait(guard, [this]{ return M_queued.load() != 0 || M_stop; });
+					M_sleeping.fetch_sub(1);
+					if (M_queued.load() == 0)
+					{
+						return;
+					}
+				}
+			}
+
+			const std::size_t M_concurrency;
+			const std::size_t M_count;
+			std::unique_ptr<Queue[]> M_queues;
+			std::unique_ptr<std::thread[]> M_threads;
+			std::atomic<std::size_t> M_queued;
+			std::atomic<std::size_t> M_sleeping;
+			std::atomic<std::size_t> M_next;
+			std::mutex M_sleep_lock;
+			std::condition_variable M_wake;
+			bool M_stop;
+			// Worker index of the calling thread, size() elsewhere
+			static thread_local std::size_t M_self;
+	};
+	thread_local std::size_t Thread_pool::M_self = std::size_t(-1);
+
+	// Futures
+	// Tasks on the pool hand their result, or the exception they threw,
+	// to a std::promise, as set_value and set_exception do across threads.
+	template <typename F, 
+							typename R>
+	struct
+	Async_task
+		: Thread_pool::Task
+	{
+		explicit
+		Async_task(F&& f)
+			: fn(std::move(f))
+		{
+			run = &M_run;
+		}
+		static
+		void
+		M_set(Async_task& a, 
+					type::true_type)
+		{
+			a.fn();
+			a.prom.set_value();
+		}
+		static
+		void
+		M_set(Async_task& a, 
+					type::false_type)
+		{
+			a.prom.set_value(a.fn());
+		}
+		static
+		void
+		M_run(Thread_pool::Task* t)
+		{
+			std::unique_ptr<Async_task> self(static_cast<Async_task*>(t));
+			try
+			{
+				M_set(*self, type::__bool_constant<std::is_void<R>::value>());
+			}
+			catch (...)
+			{
+				try
+				{
+					self->prom.set_exception(std::current_exception());
+				}
+				catch (...)
+				{
+					// set_exception() may throw too
+				}
+			}
+		}
+
+		F fn;
+		std::promise<R> prom;
+	};
+	// Runs f() on the pool
+	template <typename F>
+	std::future<decltype(std::declval<F&>()())>
+	async(F f)
+	{
+		typedef decltype(std::declval<F&>()()) R;
+		Async_task<F, R>* a = new Async_task<F, R>(std::move(f));
+		std::future<R> fut = a->prom.get_future();
+		Thread_pool::instance().submit(a);
+		return fut;
+	}
+	// Blocks until f is ready, running queued tasks meanwhile so a
+	// worker waiting on work it spawned cannot starve the pool
+	template <typename R>
+	void
+	wait(std::future<R>& f)
+	{
+		Thread_pool& pool = Thread_pool::instance();
+		while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!pool.run_one())
+			{
+				f.wait_for(std::chrono::microseconds(100));
+			}
+		}
+	}
+	template <typename R, 
+							typename... Rs>
+	void
+	wait(std::future<R>& f, 
+				std::future<Rs>&... fs)
+	{
+		lib_impl::wait(f);
+		lib_impl::wait(fs...);
+	}
+	// Ready once all of fs are, which keep their values or exceptions
+	template <typename... Rs>
+	std::future<std::tuple<std::future<Rs>...>>
+	when_all(std::future<Rs>... fs)
+	{
+		return lib_impl::async(
+						[all = std::make_tuple(std::move(fs)...)]() mutable
+						{
+							std::apply([](std::future<Rs>&... f){ lib_impl::wait(f...); }, all);
+							return std::move(all);
+						});
+	}
+
+	// Fork-join over the Thread_pool
+	// body(slot, chunk) runs for every chunk in [0, chunks), claimed in
+	// order from a shared counter by the caller and up to slots() - 1
+	// helpers queued on the pool, slot numbering the participant from 0
+	// (the caller). Idle workers steal the helpers.
+	// The first exception stops further claims and is rethrown.
+	// Callers never wait for queued work, so nested use cannot deadlock.
+	class
+	Fork_join
+	{
+		public:
+			static
+			std::size_t
+			slots(std::size_t chunks)
+			noexcept
+			{
+				const std::size_t n = Thread_pool::instance().concurrency();
+				return (chunks < n ? chunks : n);
+			}
+			template <typename Body>
+			static
+			void
+			run(std::size_t chunks, 
+					Body& body)
+			{
+				if (slots(chunks) < 2)
+				{
+					for (std::size_t c = 0; c != chunks; ++c)
+					{
+						body(std::size_t(0), c);
+					}
+					return;
+				}
+				Job job(chunks, &M_call<Body>, &body);
+				M_run(job, slots(chunks));
+			}
+		private:
+			struct
+			Job
+			{
+				Job(std::size_t n, 
+						void (*f)(void*, std::size_t, std::size_t), 
+						void* b)
+					: call(f), body(b), chunks(n), next(0), failed(false), active(0)
+				{
+				}
+				void (*call)(void*, std::size_t, std::size_t);
+				void* body;
+				std::size_t chunks;
+				std::atomic<std::size_t> next;
+				std::atomic<bool> failed;
+				std::exception_ptr error;
+				std::mutex lock;
+				std::condition_variable done;
+				std::size_t active;
+			};
+			struct
+			Helper
+				: Thread_pool::Task
+			{
+				Job* job;
+				std::size_t slot;
+			};
+
+			template <typename Body>
+			static
+			void
+			M_call(void* body, 
+							std::size_t slot, 
+							std::size_t chunk)
+			{
+				(*static_cast<Body*>(body))(slot, chunk);
+			}
+			static
+			void
+			M_claim(Job& job, 
+								std::size_t slot)
+			noexcept
+			{
+				std::size_t c;
+				while (!job.failed.load(std::memory_order_relaxed)
+							 && (c = job.next.fetch_add(1, std::memory_order_relaxed)) < job.chunks)
+				{
+					try
+					{
+						job.call(job.body, slot, c);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> guard(job.lock);
+						if (!job.error)
+						{
+							job.error = std::current_exception();
+						}
+						job.failed.store(true, std::memory_order_relaxed);
+					}
+				}
+			}
+			static
+			void
+			M_help(Thread_pool::Task* t)
+			{
+				Helper* h = static_cast<Helper*>(t);
+				Job& job = *h->job;
+				M_claim(job, h->slot);
+				std::lock_guard<std::mutex> guard(job.lock);
+				if (--job.active == 0)
+				{
+					job.done.notify_one();
+				}
+			}
+			static
+			void
+			M_run(Job& job, 
+						std::size_t slots)
+			{
+				Thread_pool& pool = Thread_pool::instance();
+				const std::size_t helpers = slots - 1;
+				std::unique_ptr<Helper[]> help(new Helper[helpers]);
+				job.active = helpers;
+				for (std::size_t i = 0; i != helpers; ++i)
+				{
+					help[i].run = &M_help;
+					help[i].job = &job;
+					help[i].slot = i + 1;
+					pool.submit(&help[i]);
+				}
+				M_claim(job, 0);
+				std::size_t taken = 0;
+				for (std::size_t i = 0; i != helpers; ++i)
+				{
+					taken += pool.cancel(&help[i]);
+				}
+				std::unique_lock<std::mutex> guard(job.lock);
+				job.active -= taken;
+				job.done.wait(guard, [&job]{ return job.active == 0; });
+				if (job.error)
+				{
+					std::rethrow_exception(job.error);
+				}
+			}
+	};
+	// Parallel reduction of element(i) for i in [0, n) with red.
+	// Chunks start from their first element, init joins first when the
+	// chunk results are combined.
+	template <typename T, 
+							typename Element,
+							typename ReduceOp>
+	T
+	parallel_reduce(bool deterministic, 
+										std::size_t n, 
+										std::size_t grain, 
+										T init, 
+										ReduceOp red, 
+										Element element)
+	{
+		const std::size_t chunks = (n + grain - 1) / grain;
+		// one result per chunk, or per participant in any order
+		const std::size_t parts = (deterministic ? chunks : Fork_join::slots(chunks));
+		std::unique_ptr<std::optional<T>[]> part(new std::optional<T>[parts]);
+		auto 
+		body = 
+		[&](std::size_t slot, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			T acc = element(c * grain);
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = red(std::move(acc), element(i));
+			}
+			std::optional<T>& p = part[deterministic ? c : slot];
+			if (p)
+			{
+				*p = red(std::move(*p), std::move(acc));
+			}
+			else
+			{
+				p.emplace(std::move(acc));
+			}
+		};
+		lib_impl::Fork_join::run(chunks, body);
+		for (std::size_t i = 0; i != parts; ++i)
+		{
+			if (part[i])
+			{
+				init = red(std::move(init), std::move(*part[i]));
+			}
+		}
+		return init;
+	}
+	// CRC-32C (Castagnoli) of a byte range, with the SSE4.2 crc32
+	// instruction when the CPU has it, else one table lookup per byte.
+	// crc chains the result of a previous call.
+	class
+	Crc32c
+	{
+		public:
+			static
+			std::uint32_t
+			compute(const void* p, 
+							std::size_t n, 
+							std::uint32_t crc = 0)
+			{
+				return ~M_kernel()(~crc, static_cast<const unsigned char*>(p), n);
+			}
+		private:
+			typedef std::uint32_t (*Kernel)(std::uint32_t, const unsigned char*, std::size_t);
+			struct
+			Table
+			{
+				std::uint32_t entries[256];
+
+				Table()
+				{
+					for (std::uint32_t i = 0; i != 256; ++i)
+					{
+						std::uint32_t c = i;
+						for (int k = 0; k != 8; ++k)
+						{
+							c = (c & 1 ? (c >> 1) ^ 0x82F63B78u : c >> 1);
+						}
+						entries[i] = c;
+					}
+				}
+			};
+			static
+			Kernel
+			M_kernel()
+			{
+				static const Kernel kernel = M_select();
+				return kernel;
+			}
+			static
+			Kernel
+			M_select()
+			{
+#if LIB_SIMD && defined(__x86_64__)
+				if (__builtin_cpu_supports("sse4.2"))
+				{
+					return &M_sse42;
+				}
+#endif
+				return &M_scalar;
+			}
+			static
+			std::uint32_t
+			M_scalar(std::uint32_t crc, 
+								const unsigned char* p, 
+								std::size_t n)
+			{
+				static const Table table;
+				for (; n != 0; --n, ++p)
+				{
+					crc = table.entries[(crc ^ *p) & 0xFFu] ^ (crc >> 8);
+				}
+				return crc;
+			}
+#if LIB_SIMD && defined(__x86_64__)
+			_Target_sse42
+			static
+			std::uint32_t
+			M_sse42(std::uint32_t crc, 
+							const unsigned char* p, 
+							std::size_t n)
+			{
+				std::uint64_t c = crc;
+				for (; n >= 8; n -= 8, p += 8)
+				{
+					std::uint64_t w;
+					std::memcpy(&w, p, 8);
+					c = _mm_crc32_u64(c, w);
+				}
+				crc = std::uint32_t(c);
+				for (; n != 0; --n, ++p)
+				{
+					crc = _mm_crc32_u8(crc, *p);
+				}
+				return crc;
+			}
+#endif
+	};
+
+	// Binary format
+	// A 64 byte header, padding up to the element alignment, then the
+	// element bytes as they are in memory. Only trivially copyable
+	// elements, read back on a machine of the same byte order.
+	struct
+	Binary_header
+	{
+		char magic[4];
+		std::uint16_t version;
+		// 0x0102 as written, 0x0201 from the other byte order
+		std::uint16_t endian;
+		std::uint32_t type_tag;
+		std::uint32_t alignment;
+		std::uint64_t count;
+		// bytes from the start of the header to the elements
+		std::uint64_t data_offset;
+		// CRC-32C of the element bytes
+		std::uint32_t checksum;
+		// CRC-32C of the header up to this field
+		std::uint32_t header_checksum;
+		char reserved[24];
+	};
+	static_assert(sizeof(Binary_header) == 64, "Binary_header is 64 bytes");
+
+	// Element type tag, kind in the high byte and the size below:
+	// 1 signed, 2 unsigned integral, 3 floating point, 0 other.
+	// Specialize to tell apart other types of the same size.
+	template <typename T>
+	struct
+	Binary_tag
+	{
+		static constexpr std::uint32_t value = 
+			(std::uint32_t(std::is_floating_point<T>::value ? 3 
+											: !std::is_integral<T>::value ? 0 
+											: std::is_signed<T>::value ? 1 : 2) << 24)
+			| std::uint32_t(sizeof(T) & 0xFFFFFFu);
+	};
+
+	template <typename T>
+	Binary_header
+	make_binary_header(const T* p, 
+											std::size_t n)
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+									"binary format elements are their bytes");
+		Binary_header h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, "LIBB", 4);
+		h.version = 1;
+		h.endian = 0x0102;
+		h.type_tag = Binary_tag<T>::value;
+		h.alignment = alignof(T);
+		h.count = n;
+		h.data_offset = (sizeof(h) + alignof(T) - 1) / alignof(T) * alignof(T);
+		h.checksum = Crc32c::compute(p, n * sizeof(T));
+		h.header_checksum = Crc32c::compute(&h, offsetof(Binary_header, header_checksum));
+		return h;
+	}
+	// Throws unless h holds elements of T
+	template <typename T>
+	void
+	check_binary_header(const Binary_header& h)
+	{
+		if (std::memcmp(h.magic, "LIBB", 4) != 0)
+		{
+			throw std::runtime_error{"binary image header is corrupt"};
+		}
+		if (h.endian != 0x0102)
+		{
+			throw std::runtime_error{"binary image has the other byte order"};
+		}
+		if (h.version != 1
+				|| h.header_checksum != Crc32c::compute(&h, offsetof(Binary_header, header_checksum)))
+		{
+			throw std::runtime_error{"binary image header is corrupt"};
+		}
+		if (h.type_tag != Binary_tag<T>::value || h.alignment != alignof(T)
+				|| h.data_offset < sizeof(h) || h.data_offset % alignof(T) != 0
+				|| h.count > std::size_t(-1) / sizeof(T))
+		{
+			throw std::runtime_error{"binary image element type mismatch"};
+		}
+	}
+	// Writes all of v[0, left), resumed after a partial write
+	inline
+	void
+	writev_exactly(int fd, 
+									struct iovec* v, 
+									int left)
+	{
+		while (left != 0)
+		{
+			const ssize_t w = ::writev(fd, v, left);
+			if (w < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				throw std::runtime_error{"write_binary failed"};
+			}
+			std::size_t done = std::size_t(w);
+			for (; left != 0 && done >= v->iov_len; --left, ++v)
+			{
+				done -= v->iov_len;
+			}
+			if (left != 0)
+			{
+				v->iov_base = static_cast<char*>(v->iov_base) + done;
+				v->iov_len -= done;
+			}
+		}
+	}
+	// Header, padding and elements in one writev. Alignments above
+	// 128 need more padding than one slice, written before the elements.
+	inline
+	void
+	write_binary(int fd, 
+								const Binary_header& h, 
+								const void* data)
+	{
+		static const char padding[64] = {};
+		std::size_t pad = std::size_t(h.data_offset) - sizeof(h);
+		const std::size_t bytes = std::size_t(h.count) * (h.type_tag & 0xFFFFFFu);
+		struct iovec iov[3] = {{const_cast<Binary_header*>(&h), sizeof(h)},
+														{const_cast<char*>(padding), (pad < sizeof(padding) ? pad : sizeof(padding))},
+														{const_cast<void*>(data), bytes}};
+		if (pad <= sizeof(padding))
+		{
+			writev_exactly(fd, iov, 3);
+			return;
+		}
+		writev_exactly(fd, iov, 2);
+		for (pad -= sizeof(padding); pad != 0; )
+		{
+			struct iovec slice = {const_cast<char*>(padding), (pad < sizeof(padding) ? pad : sizeof(padding))};
+			pad -= slice.iov_len;
+			writev_exactly(fd, &slice, 1);
+		}
+		writev_exactly(fd, iov + 2, 1);
+	}
+	inline
+	void
+	read_exactly(int fd, 
+								void* p, 
+								std::size_t n)
+	{
+		char* dst = static_cast<char*>(p);
+		while (n != 0)
+		{
+			const ssize_t r = ::read(fd, dst, n);
+			if (r < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (r <= 0)
+			{
+				throw std::runtime_error{"read_binary truncated image"};
+			}
+			dst += r;
+			n -= std::size_t(r);
+		}
+	}
+	// Reads an image of T from fd: header then elements into the
+	// storage from alloc(count), checked against the checksum
+	template <typename T, 
+							typename Alloc>
+	void
+	read_binary(int fd, 
+							Alloc alloc)
+	{
+		Binary_header h;
+		read_exactly(fd, &h, sizeof(h));
+		check_binary_header<T>(h);
+		char padding[64];
+		for (std::size_t pad = std::size_t(h.data_offset) - sizeof(h); pad != 0; )
+		{
+			const std::size_t n = (pad < sizeof(padding) ? pad : sizeof(padding));
+			read_exactly(fd, padding, n);
+			pad -= n;
+		}
+		// A regular file must hold count elements before they are allocated
+		struct stat st;
+		const off_t at = ::lseek(fd, 0, SEEK_CUR);
+		if (at >= 0 && ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+				&& (st.st_size < at || h.count > std::uint64_t(st.st_size - at) / sizeof(T)))
+		{
+			throw std::runtime_error{"read_binary truncated image"};
+		}
+		T* data = alloc(std::size_t(h.count));
+		read_exactly(fd, data, std::size_t(h.count) * sizeof(T));
+		if (Crc32c::compute(data, std::size_t(h.count) * sizeof(T)) != h.checksum)
+		{
+			throw std::runtime_error{"binary image checksum mismatch"};
+		}
+	}
+	// Elements of T in a buffer holding a whole image
+	template <typename T>
+	const T*
+	binary_elements(const void* buffer, 
+										std::size_t bytes, 
+										std::size_t& count, 
+										bool verify)
+	{
+		if (bytes < sizeof(Binary_header))
+		{
+			throw std::runtime_error{"binary image truncated"};
+		}
+		Binary_header h;
+		std::memcpy(&h, buffer, sizeof(h));
+		check_binary_header<T>(h);
+		if (h.data_offset > bytes || h.count > (bytes - h.data_offset) / sizeof(T))
+		{
+			throw std::runtime_error{"binary image truncated"};
+		}
+		const char* data = static_cast<const char*>(buffer) + h.data_offset;
+		if (reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
+		{
+			throw std::runtime_error{"binary image misaligned"};
+		}
+		if (verify && Crc32c::compute(data, std::size_t(h.count) * sizeof(T)) != h.checksum)
+		{
+			throw std::runtime_error{"binary image checksum mismatch"};
+		}
+		count = std::size_t(h.count);
+		return reinterpret_cast<const T*>(data);
+	}
+	//---
+}
+//--- NS lib_impl
+//-- User library
+namespace
+lib
+{
+  // MISRA C++
+  // Compliant Rule 7–3–4 and Rule 7–3–6
+  // using-directives and using-declarations shall not be used
+  // (excluding class scope or function scope using-declarations)
+
+	// Selects the constructor leaving trivial elements uninitialized
+	struct
+	Default_init_t
+	{
+		explicit
+		Default_init_t() = default;
+	};
+	constexpr Default_init_t default_init{};
+	// Selects the constructor taking over storage with its elements
+	struct
+	Adopt_t
+	{
+		explicit
+		Adopt_t() = default;
+	};
+	constexpr Adopt_t adopt{};
+
+	// Vector Base
+	// Memory management
+	// Nothing construct or destroy T elements
+	template <typename T, 
+							typename A,
+							typename G = lib_impl::Growth_double>
+	struct
+	Vector_base
+	{
+		typedef typename A::template rebind<T>::other T_alloc_type;
+		typedef G growth_policy;
+		struct 
+		Vector_impl
+			: public T_alloc_type
+		{
+			// Representation
+			typename T_alloc_type::pointer M_start{};
+			typename T_alloc_type::pointer M_finish{};	
+			typename T_alloc_type::pointer M_end{};	
+			
+			Vector_impl(const T_alloc_type& a)
+				: T_alloc_type(a), 
+					M_start(0), 
+					M_finish(0), 
+					M_end(0)
+			{
+			}
+			Vector_impl()
+				: Vector_impl(T_alloc_type()) 
+			{
+			}						
+		};
+		// Representation		
+		Vector_impl M_impl;
+		
+		// Statistics hook of the allocator, null without one
+		lib_impl::Alloc_stats*
+		M_stats() const
+		{
+			return lib_impl::alloc_stats(static_cast<const T_alloc_type&>(M_impl));
+		}
+		typename T_alloc_type::pointer
+		M_allocate(std::size_t n)
+		{
+			if (n == 0)
+			{
+				return 0;
+			}
+			typename T_alloc_type::pointer p = M_impl.allocate(n);
+			if (lib_impl::Alloc_stats* s = M_stats())
+			{
+				s->allocated(n * sizeof(T));
+			}
+			return p;
+		}
+		// n is updated to the number of elements really allocated.
+		// Reported as growth when it replaces the current storage.
+		typename T_alloc_type::pointer
+		M_allocate_at_least(std::size_t& n)
+		{
+			if (n == 0)
+			{
+				return 0;
+			}
+			typename T_alloc_type::pointer p 
+				= M_allocate_at_least(n, type::has_allocate_at_least<T_alloc_type>());
+			if (lib_impl::Alloc_stats* s = M_stats())
+			{
+				s->allocated(n * sizeof(T));
+				if (this->M_impl.M_start)
+				{
+					s->grown();
+				}
+			}
+			return p;
+		}
+		typename T_alloc_type::pointer
+		M_allocate_at_least(std::size_t& n,
+													type::true_type)
+		{
+			auto result = M_impl.allocate_at_least(n);
+			n = (result.count < n ? n : result.count);
+			return result.ptr;
+		}
+		typename T_alloc_type::pointer
+		M_allocate_at_least(std::size_t& n,
+													type::false_type)
+		{
+			return M_impl.allocate(n);
+		}
+		// Growth in place keeps element bytes, only for relocatable T.
+		static
+		constexpr
+		bool
+		M_use_reallocate()
+		{
+			return (bool(type::has_reallocate<T_alloc_type>())
+							&& bool(type::is_trivially_relocatable<T>()));
+		}
+		// Grows storage to at least n elements keeping the elements,
+		// n is updated to the new capacity. 
+		// Returns false, storage untouched, when the allocator declines.
+		bool
+		M_reallocate(std::size_t& n)
+		{
+			return M_reallocate(n, type::__bool_constant<M_use_reallocate()>());
+		}
+		bool
+		M_reallocate(std::size_t&, 
+									type::false_type)
+		{
+			return false;
+		}
+		bool
+		M_reallocate(std::size_t& n, 
+									type::true_type)
+		{
+			if (!this->M_impl.M_start)
+			{
+				return false;
+			}
+			// the old block may be freed by the call, nothing reads it after
+			const std::size_t size = this->M_impl.M_finish - this->M_impl.M_start;
+			const std::size_t old_cap = this->M_impl.M_end - this->M_impl.M_start;
+			auto result = M_impl.reallocate_at_least(this->M_impl.M_start, old_cap, n);
+			if (!result.ptr)
+			{
+				return false;
+			}
+			n = (result.count < n ? n : result.count);
+			if (lib_impl::Alloc_stats* s = M_stats())
+			{
+				s->reallocated(old_cap * sizeof(T), n * sizeof(T));
+			}
+			this->M_impl.M_start = result.ptr;
+			this->M_impl.M_finish = result.ptr + size;
+			this->M_impl.M_end = result.ptr + n;
+			return true;
+		}
+		// Storage of zero bytes, only scalars are valid as zero bytes
+		static
+		constexpr
+		bool
+		M_use_allocate_zeroed()
+		{
+			return (bool(type::has_allocate_zeroed<T_alloc_type>())
+							&& std::is_scalar<T>::value);
+		}
+		typename T_alloc_type::pointer
+		M_allocate_zeroed(std::size_t n)
+		{
+			if (n == 0)
+			{
+				return 0;
+			}
+			typename T_alloc_type::pointer p = M_impl.allocate_zeroed(n);
+			if (lib_impl::Alloc_stats* s = M_stats())
+			{
+				s->allocated(n * sizeof(T));
+			}
+			return p;
+		}
+		void
+		M_deallocate(typename T_alloc_type::pointer p, 
+									std::size_t n)
+		{
+			if (p)
+			{
+				if (lib_impl::Alloc_stats* s = M_stats())
+				{
+					s->deallocated(n * sizeof(T));
+				}
+				M_impl.deallocate(p, n);
+			}
+		}
+		// Allocator access
+		typedef A allocator_type;	
+		allocator_type&	
+		M_get_T_allocator()
+		{
+			return *static_cast<T_alloc_type*>(&this->M_impl);
+		}
+		const allocator_type&	
+		M_get_T_allocator() const
+		{
+			return *static_cast<const T_alloc_type*>(&this->M_impl);
+		}
+		allocator_type
+		get_allocator() const	
+		{
+			return allocator_type(M_get_T_allocator());
+		}
+		//
+		Vector_base(std::size_t n, 
+								const allocator_type& a)	
+			: M_impl(a)
+		{
+			// allocate memory
+			this->M_impl.M_start = this->M_allocate(n);
+			this->M_impl.M_finish = this->M_impl.M_start;
+			this->M_impl.M_end = this->M_impl.M_start + n;
+		}
+		Vector_base(std::size_t n)
+			: Vector_base(n, get_allocator())
+		{
+		}
+		Vector_base()
+			: Vector_base(std::size_t(0), get_allocator())
+		{
+		}
+		Vector_base(const allocator_type& a)
+			: Vector_base(std::size_t(0), a)
+		{
+		}
+		// No copy
+		Vector_base(const Vector_base&)	= delete;
+		Vector_base&
+		operator=(const Vector_base&) = delete;
+		// Allow move	
+		Vector_base(Vector_base&& other)
+			: M_impl(other.M_get_T_allocator())
+		{
+			this->M_impl.M_start = other.M_impl.M_start;
+			this->M_impl.M_finish = other.M_impl.M_finish;
+			this->M_impl.M_end = other.M_impl.M_end;
+			// stable state
+			other.M_impl.M_start = 0;
+			other.M_impl.M_finish = 0;
+			other.M_impl.M_end = 0;
+		}
+		Vector_base&
+		operator=(Vector_base&& other)
+		{
+			std::swap(M_impl.M_start,other.M_impl.M_start);
+			std::swap(M_impl.M_finish,other.M_impl.M_finish);
+			std::swap(M_impl.M_end,other.M_impl.M_end);	
+			return *this;					
+		}
+		~Vector_base()
+		{
+			M_deallocate(this->M_impl.M_start, 
+										this->M_impl.M_end - this->M_impl.M_start);										
+		}
+	};
+	//---
+	// Vector
+	
+	template <typename T, 
+						typename A,
+						typename G = lib_impl::Growth_double>
+	class
+	Vector
+		// AUTOSAR Rule A10-0-2
+		// Membership or non-public inheritance shall be used to implement “has-a” relationship.
+		: protected Vector_base<T, A, G>
+	{			
+		// Private implementation details
+      using Alloc_value_type					= typename A::value_type; 
+      using Base											= Vector_base<T, A, G>;
+      using T_alloc_type							= typename Base::T_alloc_type;
+      using Alloc_traits							= lib_impl::Alloc_traits<T_alloc_type>;
+      template <typename U>
+      using Iter											= lib_impl::Normal_iterator<U,Vector>;
+      template <typename U>
+      using Reverse_iter							= lib_impl::Reverse_iterator<U>;	
+		
+		// Concept requirements 
+      // MISRA C++
+      // Rule 16–0–4
+      // Function-like macros shall not be defined.
+      // used inline functions instead for safer type checking of parameters.
+
+			// Concept requirements 
+			typedef Iter<typename T_alloc_type::pointer> iter;
+      typedef Vector<T,A,G> Vector_t; 
+        // Member functions of a local class are implicitly inline functions.
+      static
+      void 
+      M_constraints() 
+      {
+        // Requirements for element type T used by Vector
+        type::__function_requires< type::SGIAssignableConcept<T> >();
+        type::__function_requires< type::ContiguousIteratorConcept<iter> >();
+        // Requirements for the container Vector
+        type::__function_requires< type::ContainerConcept<Vector_t> >(); 
+        type::__function_requires< type::AllocatorAwareContainerConcept<Vector_t> >(); 
+        type::__function_requires< type::ReversibleContainerConcept<Vector_t> >();   
+        type::__function_requires< type::SequenceContainerConcept<Vector_t> >();   
+
+      }
+      typedef type::_class_requires< &M_constraints > _concept_requirements_t;	
+
+		public:
+			using value_type							= T;
+			using pointer									= typename T_alloc_type::pointer;
+			using const_pointer						= typename T_alloc_type::const_pointer;
+			using reference								= typename T_alloc_type::reference;
+			using const_reference					= typename T_alloc_type::const_reference;	
+			using iterator								= Iter<pointer>;	
+			using const_iterator					= Iter<const_pointer>;	
+			using reverse_iterator				= Reverse_iter<iterator>;
+			using const_reverse_iterator	= Reverse_iter<const_iterator>;
+			using size_type								= std::size_t;
+			using difference_type					= std::ptrdiff_t;
+			using allocator_type					= A;
+			using growth_policy						= G;
+			using subscript_policy				= lib_impl::Subscript_check;
+			// Alignment data() always has, for aligned SIMD loads
+			static constexpr size_type alignment = type::alloc_alignment<T_alloc_type>{}();
+			static_assert(alignment % alignof(T) == 0, "allocator does not align T");
+
+			explicit
+			Vector(size_type n, 
+							const value_type& val,
+							const allocator_type& a = allocator_type())
+				: Base(a)
+			{
+				// alloacate memory and initialize
+				M_fill_create(n, val, type::__bool_constant<Base::M_use_allocate_zeroed()>());
+			}
+			// Trivial elements are not initialized
+			Vector(size_type n, 
+							Default_init_t,
+							const allocator_type& a = allocator_type())
+				: Base(n, a)
+			{
+				this->M_impl.M_finish = lib_impl::uninitialized_default_n_a(this->M_impl.M_start, 
+																																			n, 
+																																			M_get_T_allocator());
+			}
+			// Takes over [p, p + n) in storage of cap elements from a,
+			// the elements are already constructed
+			Vector(Adopt_t,
+							pointer p, 
+							size_type n, 
+							size_type cap,
+							const allocator_type& a)
+				: Base(a)
+			{
+				this->M_impl.M_start = p;
+				this->M_impl.M_finish = p + n;
+				this->M_impl.M_end = p + cap;
+			}
+			Vector()
+				: Vector(size_type(0), value_type(), allocator_type())
+			{
+			}
+			Vector(const allocator_type& a)
+				: Vector(size_type(0), value_type(), a)
+			{
+			}	
+			explicit
+			Vector(size_type n)		
+				: Vector(n, value_type(), allocator_type())
+			{
+			}
+      template < class InputIt >
+      Vector(InputIt first, 
+              InputIt last,
+              const A& alloc = allocator_type())
+        : Base(alloc)
+      {
+        typedef typename std::is_integral<InputIt>::type Integral;
+        M_initialize_dispatch(first, last, Integral());
+      }
+      // AUTOSAR C++
+      // Compliant Rule A12-0-1
+      // “the rule of five”
+      // five special member functions
+      // - copy and move constructor
+      // - copy and move assignment
+      // - destructor
+			Vector(const Vector& other)	
+				: Base(other.size(), 
+								Alloc_traits::select_on_container_copy_construction(other.M_get_T_allocator()))	
+			{
+				this->M_impl.M_finish = M_copy_initialize(other.begin(), 
+																										other.end(), 
+																										this->M_impl.M_start);
+			}
+			Vector&
+			operator=(const Vector& other);
+			Vector(Vector&& other)
+				: Base(std::move(other))	
+			{
+			}	
+			Vector&
+			operator=(Vector&& other)
+			{
+				M_move_assign(std::move(other),
+											type::__bool_constant<
+												bool(typename Alloc_traits::propagate_on_container_move_assignment{})
+												|| bool(typename Alloc_traits::is_always_equal{})>());
+				return *this;
+			}					
+			~Vector()
+			{
+				M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
+			}
+      //
+      Vector(const Vector& other, 
+              const A& alloc)
+				: Base(other.size(), alloc)	
+			{
+				this->M_impl.M_finish = lib_impl::uninitialized_copy_a(other.begin(), 
+																										            other.end(), 
+																										            this->M_impl.M_start,
+                                                                alloc);
+			}
+			Vector(Vector&& other, 
+							const A& alloc)
+				: Base(alloc)
+			{
+				if (other.M_get_T_allocator() == alloc)
+				{
+					M_swap_data(other);
+				}
+				else
+				{
+					// memory of other cannot be freed by alloc
+					M_assign_move(other.M_impl.M_start, other.M_impl.M_finish);
+					other.clear();
+				}
+			}
+			Vector(lib_impl::initializer_list<value_type> l)
+				: Base(l.size())
+			{
+				this->assign(l.begin(), l.end());
+			}			
+			Vector&
+			operator=(lib_impl::initializer_list<value_type> l)
+			{
+				this->assign(l.begin(), l.end());
+				return *this;
+			}
+			iterator
+			begin()
+			{ 
+				return iterator(this->M_impl.M_start); 
+			}
+			const_iterator
+			begin() const
+			{ 
+				return const_iterator(this->M_impl.M_start); 
+			}
+			iterator
+			end()
+			{ 
+				return iterator(this->M_impl.M_finish); 
+			}	
+			const_iterator
+			end() const
+			{ 
+				return const_iterator(this->M_impl.M_finish); 
+			}
+			reverse_iterator
+			rbegin()
+			{ 
+				return reverse_iterator(end()); 
+			}
+			const_reverse_iterator
+			rbegin() const
+			{ 
+				return const_reverse_iterator(end()); 
+			}
+			reverse_iterator
+			rend()
+			{ 
+				return reverse_iterator(begin()); 
+			}		
+			const_reverse_iterator
+			rend() const
+			{ 
+				return const_reverse_iterator(begin()); 
+			}	
+			size_type
+			size() const
+			{ 
+				return size_type(this->M_impl.M_finish - this->M_impl.M_start); 
+			}	
+			size_type
+			max_size() const
+			{ 
+				return M_get_T_allocator().max_size(); 
+			}	
+			size_type
+			capacity()
+			{ 
+				return size_type(this->M_impl.M_end - this->M_impl.M_start);	
+			}						
+			using Base::get_allocator;
+			// Allocators which do not propagate on swap must compare equal
+			void
+			swap(Vector& other)	
+			{
+				M_swap_data(other);
+				M_swap_allocator(other, typename Alloc_traits::propagate_on_container_swap());
+			}
+			void
+			clear()
+			{
+				M_erase_at_end(this->M_impl.M_start);
+			}
+			bool
+			empty() const
+			{
+				return bool(begin() == end());
+			}
+			// Checked by subscript_policy, a plain load in release builds
+			reference
+			operator[](size_type n)
+			{
+				subscript_policy::check(n, this->size());
+				return *(this->M_impl.M_start + n); 
+			}
+			const_reference
+			operator[](size_type n) const
+			{
+				subscript_policy::check(n, this->size());
+				return *(this->M_impl.M_start + n); 
+			}
+			// Never checked
+			reference
+			unchecked_at(size_type n)
+			noexcept
+			{
+				return *(this->M_impl.M_start + n); 
+			}
+			const_reference
+			unchecked_at(size_type n) const
+			noexcept
+			{
+				return *(this->M_impl.M_start + n); 
+			}
+			// Always checked
+			reference
+			at(size_type n)
+			{
+				M_range_check(n);
+				return unchecked_at(n);
+			}	
+			const_reference
+			at(size_type n) const
+			{
+				M_range_check(n);
+				return unchecked_at(n);
+			}
+			reference
+			front()
+			{
+				return (*begin());
+			}	
+			const_reference
+			front() const
+			{
+				return (*begin());
+			}
+			reference
+			back()
+			{
+				return (*(end() - 1));
+			}	
+			const_reference
+			back() const
+			{
+				return (*(end() - 1));
+			}	
+			pointer
+			data()
+			{
+				return std::addressof(front());
+			}	
+			const_pointer
+			data() const
+			{
+				return std::addressof(front());
+			}
+			void
+			push_back(const_reference val)	
+			{
+				if (this->M_impl.M_finish != this->M_impl.M_end)
+				{
+					this->M_impl.construct(this->M_impl.M_finish, val);
+					++this->M_impl.M_finish;
+				}
+				else
+				{
+					M_insert_aux(end(), val);
+				}
+			}
+			void
+			push_back(value_type&& val)	
+			{
+				emplace_back(std::move(val));
+			}
+			
+			template <typename... Args>	
+			void
+			emplace_back(Args&&... args)
+			{
+				if (this->M_impl.M_finish != this->M_impl.M_end)
+				{
+					this->M_impl.construct(this->M_impl.M_finish,
+																	std::forward<Args>(args)...);
+					++this->M_impl.M_finish;
+				}
+				else
+				{
+					M_insert_aux(end(), std::forward<Args>(args)...);
+				}
+			}	
+			void
+			pop_back()
+			{
+				--this->M_impl.M_finish;
+				this->M_impl.destroy(this->M_impl.M_finish);
+			}								
+			void
+			assign(size_type n, 
+							const value_type& val)	
+			{
+				M_fill_assign(n, val);
+			}
+			void
+			assign(const std::initializer_list<value_type> l)
+			{
+				this->assign(l.begin(), l.end());
+			}
+			template <typename InputIterator>	
+			void
+			assign(InputIterator first,
+							InputIterator last)
+			{
+				pointer curr(this->M_impl.M_start);
+				for (; first != last && curr != this->M_impl.M_finish; ++curr, ++first)
+					*curr = *first;
+				if (first == last)
+				{
+					M_erase_at_end(curr);
+				}
+				else
+				{
+					insert(end(), first, last);
+				}
+			}
+			template <typename InputIterator>	
+			void
+			insert(iterator pos, 
+			 				InputIterator first,	
+			 				InputIterator last)
+			{
+				M_range_insert(pos, first, last); 	
+			}
+			iterator
+			insert(iterator pos, 
+							const value_type& val)
+			{
+				const size_type n = pos - begin();
+				if (this->M_impl.M_finish != this->M_impl.M_end
+							&& pos == end()) 
+				{
+					this->M_impl.construct(this->M_impl.M_finish, val);
+					++this->M_impl.M_finish;
+				}
+				else
+				{
+					if (this->M_impl.M_finish != this->M_impl.M_end)
+					{
+						value_type val_copy = val;
+						M_insert_aux(pos, std::move(val_copy));
+					}
+					else
+					{
+						M_insert_aux(pos, val);
+					}
+				}
+				return iterator(this->M_impl.M_start + n);
+			} 			
+			iterator
+			insert(iterator pos, 
+							value_type&& val)
+			{
+				return emplace(pos, std::move(val)); 
+			} 
+			void
+			insert(iterator pos, 
+							std::initializer_list<value_type> l)
+			{
+				this->insert(pos, l.begin(), l.end());
+			}
+			void
+			insert(iterator pos, 
+							size_type n, 
+							const value_type& val)
+			{
+				M_fill_insert(pos, n, val);
+			}
+			template <typename... Args>
+			iterator
+			emplace(iterator pos, 
+								Args&&... args)
+			{
+				const size_type n = pos - begin();
+				if (this->M_impl.M_finish != this->M_impl.M_end && pos == end())
+				{
+					this->M_impl.construct(this->M_impl.M_finish,
+																	std::forward<Args>(args)...);
+					++this->M_impl.M_finish;
+				}
+				else
+				{
+					M_insert_aux(pos, std::forward<Args>(args)...);
+				}
+				return iterator(this->M_impl.M_start + n);
+			}
+			iterator
+			erase(iterator pos)
+			{
+				if (pos + 1 != end())
+				{
+					lib_impl::move(pos + 1, end(), pos);				
+				}
+				--this->M_impl.M_finish;
+				this->M_impl.destroy(this->M_impl.M_finish);
+				return pos;
+			}
+			iterator
+			erase(iterator first, 
+							iterator last)
+			{
+				if (first != last)
+				{
+					if (last != end())
+					{
+						lib_impl::move(last, end(), first);
+					}
+					M_erase_at_end(first.base() + (end() - last));
+				}
+				return first;
+			}
+			
+			void
+			reserve(size_type n);
+			
+			void
+			resize(size_type new_size, 
+							value_type val = value_type())
+			{
+				if (new_size > size())
+				{
+					insert(end(), new_size - size(), val);
+				}
+				else if (new_size < size())
+				{
+					M_erase_at_end(this->M_impl.M_start + new_size);
+				}
+			}
+			// Added trivial elements are not initialized, 
+			// meant for Vectors about to be overwritten
+			void
+			resize_default_init(size_type new_size)
+			{
+				if (new_size > size())
+				{
+					M_default_append(new_size - size());
+				}
+				else if (new_size < size())
+				{
+					M_erase_at_end(this->M_impl.M_start + new_size);
+				}
+			}
+		protected:
+			// Representation
+			using Base::M_impl;
+			using Base::M_allocate;
+			using Base::M_deallocate;
+			using Base::M_get_T_allocator;
+			
+			// Member functions
+			void
+			M_fill_initialize(size_type n, 
+												const value_type& val)
+			{
+				lib_impl::uninitialized_fill_n_a(this->M_impl.M_start, n, val, M_get_T_allocator());
+				this->M_impl.M_finish = this->M_impl.M_end;
+			}
+			// Allocates and fills n elements
+			void
+			M_fill_create(size_type n, 
+											const value_type& val,
+											type::false_type)
+			{
+				this->M_impl.M_start = this->M_allocate(n);
+				this->M_impl.M_finish = this->M_impl.M_start;
+				this->M_impl.M_end = this->M_impl.M_start + n;
+				M_fill_initialize(n, val);
+			}
+			// A zero val is already there in zeroed storage
+			void
+			M_fill_create(size_type n, 
+											const value_type& val,
+											type::true_type)
+			{
+				const unsigned char zero[sizeof(value_type)] = {};
+				if (std::memcmp(std::addressof(val), zero, sizeof(value_type)) != 0)
+				{
+					M_fill_create(n, val, type::false_type());
+					return;
+				}
+				this->M_impl.M_start = this->M_allocate_zeroed(n);
+				this->M_impl.M_finish = this->M_impl.M_start + n;
+				this->M_impl.M_end = this->M_impl.M_finish;
+			}
+			void
+			M_default_append(size_type n)
+			{
+				if (size_type(this->M_impl.M_end - this->M_impl.M_finish) < n)
+				{
+					reserve(M_check_len(n, "Vector::resize_default_init"));
+				}
+				this->M_impl.M_finish = lib_impl::uninitialized_default_n_a(this->M_impl.M_finish, 
+																																			n, 
+																																			M_get_T_allocator());
+			}
+			
+			template<typename InputIterator,
+								typename ForwardIterator>
+			ForwardIterator 
+			M_copy_initialize(InputIterator first, 
+														InputIterator last,
+														ForwardIterator	result)
+			{
+				return lib_impl::uninitialized_copy_a(first, 
+																							last, 
+																							result,
+																							M_get_T_allocator());			
+			}
+				
+			template<typename InputIterator>
+			void 
+			M_destroy(InputIterator first, 
+									InputIterator last)
+			{
+				lib_impl::destroy_a(first,last,M_get_T_allocator());
+			}
+			
+			template<typename InputIterator, 
+								typename ForwardIterator>
+			ForwardIterator
+			M_copy(InputIterator first, 
+			 			InputIterator last,
+			 			ForwardIterator result)
+			{	
+				return lib_impl::copy(first,last,result);
+			}
+				
+			template<typename ForwardIterator>
+			pointer
+			M_allocate_and_copy(size_type n,
+													ForwardIterator first, 
+													ForwardIterator last)	
+			{
+				pointer result = this->M_allocate(n);
+				try
+				{
+					M_copy_initialize(first, last, result);
+					return result;
+				}
+				catch(...)
+				{
+					M_deallocate(result, n);
+					throw std::runtime_error{"Copy initialization failed"};
+				}
+			}
+
+			pointer
+			M_relocate(pointer first,
+									pointer last,
+									pointer result)
+			{
+				return lib_impl::uninitialized_relocate_a(first,
+																									last,
+																									result,
+																									M_get_T_allocator());
+			}
+
+			void
+			M_destroy_relocated(pointer first,
+														pointer last)
+			{
+				lib_impl::destroy_relocated_a(first, last, M_get_T_allocator());
+			}
+
+			pointer
+			M_allocate_and_relocate(size_type n,
+																pointer first,
+																pointer last)
+			{
+				pointer result = this->M_allocate(n);
+				try
+				{
+					M_relocate(first, last, result);
+					return result;
+				}
+				catch(...)
+				{
+					M_deallocate(result, n);
+					throw;
+				}
+			}
+
+			void
+			M_erase_at_end(pointer pos)
+			{
+				M_destroy(pos, this->M_impl.M_finish);
+				this->M_impl.M_finish = pos;
+			}
 			
-			Vector_impl(const T_alloc_type& a)
-				: T_alloc_type(a), 
-					M_start(0), 
-					M_finish(0), 
-					M_end(0)
+			void
+			M_fill_assign(size_type n, const value_type& val);
+
+			void
+			M_copy_assign_allocator(const Vector& other, 
+																type::true_type)
 			{
+				if (!(M_get_T_allocator() == other.M_get_T_allocator()))
+				{
+					// current storage must be freed by the current allocator
+					M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
+					M_deallocate(this->M_impl.M_start, this->M_impl.M_end - this->M_impl.M_start);
+					this->M_impl.M_start = 0;
+					this->M_impl.M_finish = 0;
+					this->M_impl.M_end = 0;
+				}
+				static_cast<T_alloc_type&>(this->M_impl) = other.M_get_T_allocator();
 			}
-			Vector_impl()
-				: Vector_impl(T_alloc_type()) 
+			void
+			M_copy_assign_allocator(const Vector&, 
+																type::false_type)
 			{
-			}						
-		};
-		// Representation		
-		Vector_impl M_impl;
-		
-		typename T_alloc_type::pointer
-		M_allocate(std::size_t n)
+			}
+			void
+			M_swap_data(Vector& other)
+			{
+				std::swap(this->M_impl.M_start, other.M_impl.M_start);
+				std::swap(this->M_impl.M_finish, other.M_impl.M_finish);
+				std::swap(this->M_impl.M_end, other.M_impl.M_end);
+			}
+			void
+			M_swap_allocator(Vector& other, 
+												type::true_type)
+			{
+				std::swap(static_cast<T_alloc_type&>(this->M_impl), 
+									static_cast<T_alloc_type&>(other.M_impl));
+			}
+			void
+			M_swap_allocator(Vector&, 
+												type::false_type)
+			{
+			}
+			// Storage of other can be taken over
+			void
+			M_move_assign(Vector&& other, 
+											type::true_type)
+			{
+				this->clear();
+				M_swap_data(other);
+				M_swap_allocator(other, 
+													typename Alloc_traits::propagate_on_container_move_assignment());
+			}
+			// Storage of other is taken over only from an equal allocator,
+			// elements are moved one by one otherwise
+			void
+			M_move_assign(Vector&& other, 
+											type::false_type)
+			{
+				if (other.M_get_T_allocator() == M_get_T_allocator())
+				{
+					M_move_assign(std::move(other), type::true_type());
+				}
+				else
+				{
+					M_assign_move(other.M_impl.M_start, other.M_impl.M_finish);
+					other.clear();
+				}
+			}
+			// Move assigns [first, last) of another Vector to this one
+			void
+			M_assign_move(pointer first, 
+											pointer last)
+			{
+				const size_type len = last - first;
+				if (len > capacity())
+				{
+					pointer tmp = this->M_allocate(len);
+					try
+					{
+						lib_impl::uninitialized_move_a(first, last, tmp, M_get_T_allocator());
+					}
+					catch(...)
+					{
+						M_deallocate(tmp, len);
+						throw;
+					}
+					M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
+					M_deallocate(this->M_impl.M_start, this->M_impl.M_end - this->M_impl.M_start);
+					this->M_impl.M_start = tmp;
+					this->M_impl.M_finish = tmp + len;
+					this->M_impl.M_end = tmp + len;
+				}
+				else if (size() >= len)
+				{
+					M_erase_at_end(lib_impl::move(first, last, this->M_impl.M_start));
+				}
+				else
+				{
+					pointer mid = first + size();
+					lib_impl::move(first, mid, this->M_impl.M_start);
+					this->M_impl.M_finish = lib_impl::uninitialized_move_a(mid, 
+																																	last, 
+																																	this->M_impl.M_finish, 
+																																	M_get_T_allocator());
+				}
+			}
+			
+			template <typename InputIterator>
+			void
+			M_range_insert(iterator pos, 
+											InputIterator first,
+											InputIterator last)
+			{
+				typedef typename type::Iterator_traits<InputIterator>::iterator_category 
+				IterCategory;
+				M_range_insert(pos, first, last, IterCategory());
+			}
+
+			template <typename InputIterator>
+			void
+			M_range_insert(iterator pos, 
+											InputIterator first,
+											InputIterator last,
+											type::input_iterator_tag)
+			{
+				// single pass, length unknown
+				for (; first != last; ++first, ++pos)
+				{
+					pos = insert(pos, *first);
+				}
+			}
+
+			template <typename ForwardIterator>
+			void
+			M_range_insert(iterator pos, 
+											ForwardIterator first,
+											ForwardIterator last,
+											type::forward_iterator_tag);
+			
+			template <typename... Args>
+			void
+			M_insert_aux(iterator pos, 
+										Args&&... args);
+
+			template <typename... Args>
+			void
+			M_realloc_insert(iterator pos, 
+												Args&&... args);
+
+			// val is one of the elements
+			bool
+			M_holds(const value_type& val) const
+			{
+				const std::less<const_pointer> less{};
+				return (!less(std::addressof(val), this->M_impl.M_start)
+								&& less(std::addressof(val), this->M_impl.M_finish));
+			}
+
+			// Room for n more elements at the end without moving them
+			bool
+			M_reallocate_append(size_type n, 
+														const char* s)
+			{
+				if (!Base::M_use_reallocate())
+				{
+					return false;
+				}
+				size_type len = M_check_len(n, s);
+				return this->M_reallocate(len);
+			}
+			
+			void
+			M_fill_insert(iterator pos, 
+										size_type n, 
+										const value_type& val);
+			
+			size_type
+			M_check_len(size_type n, 
+									const char* s) const
+			{
+				if (max_size() - size() < n)
+					throw std::runtime_error{s};
+				const size_type len = growth_policy::next(size(), n, M_get_T_allocator());
+				return ((len < size() + n || len > max_size()) ? max_size() : len);											
+			}
+			
+			void
+			M_range_check(size_type n) const
+			{
+				lib_impl::Range_checked::check(n, this->size());
+			}
+      template <typename Integer>
+      void
+      M_initialize_dispatch(Integer n, 
+                              Integer value, 
+                              std::integral_constant<bool, true>)
+      {
+        this->M_impl.M_start = M_allocate(static_cast<size_type>(n));
+        this->M_impl.M_end = this->M_impl.M_start + static_cast<size_type>(n);
+        M_fill_initialize(static_cast<size_type>(n),value);
+      }
+
+      template <typename InputIt>
+      void
+      M_initialize_dispatch(InputIt first, 
+                              InputIt last,
+                              std::integral_constant<bool, false>)
+      {
+        typedef typename type::Iterator_traits<InputIt>::iterator_category 
+        IterCategory;
+        M_range_initialize(first, last, IterCategory());
+      } 
+      template <typename InputIt>
+      void
+      M_range_initialize(InputIt first,
+                          InputIt last, 
+                          type::input_iterator_tag)
+      {
+        for (; first != last; ++first)
+        {
+          push_back(*first);
+        }
+      }
+
+      template<typename ForwardIt>
+      void
+      M_range_initialize(ForwardIt first,
+                          ForwardIt last, 
+                          type::forward_iterator_tag)
+      {
+        const size_type n = lib_impl::distance(first, last);
+        this->M_impl.M_start = this->M_allocate(n);
+        this->M_impl.M_end = this->M_impl.M_start + n;
+        this->M_impl.M_finish = M_copy_initialize(first, last, this->M_impl.M_start);
+      }           
+	};
+	template <typename T,
+						typename A,
+						typename G>
+	Vector<T,A,G>&
+	Vector<T,A,G>::
+	operator=(const Vector<T,A,G>& other)
+	{
+		// check for self copy	
+		if (&other != this)
 		{
-			return (n != 0 ? M_impl.allocate(n) : 0);
+			M_copy_assign_allocator(other, 
+															typename Alloc_traits::propagate_on_container_copy_assignment());
+			const size_type len = other.size();
+			if (len > capacity())
+			{
+				pointer tmp = M_allocate_and_copy(len, other.begin(),other.end());
+				M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
+				M_deallocate(this->M_impl.M_start,this->M_impl.M_end - this->M_impl.M_start);
+				this->M_impl.M_start = tmp;
+				this->M_impl.M_end = this->M_impl.M_start + len;
+			}
+			else if (size() >= len)
+			{
+				M_destroy(M_copy(other.begin(), other.end(), begin()),
+									end());
+			}
+			else
+			{
+				M_copy(other.M_impl.M_start, other.M_impl.M_start + size(), this->M_impl.M_start);
+				M_copy_initialize(other.M_impl.M_start + size(),
+														other.M_impl.M_finish,
+														this->M_impl.M_finish);
+			}
+			this->M_impl.M_finish = this->M_impl.M_start + len;
 		}
-		void
-		M_deallocate(typename T_alloc_type::pointer p, 
-									std::size_t n)
+		return *this;
+	}
+	
+	template <typename T,
+						typename A,
+						typename G>
+	void
+	Vector<T,A,G>::
+	M_fill_assign(size_type n, 
+								const value_type& val)	
+	{
+		if (n > capacity())	
 		{
-			if (p)
+			// New storage always comes from this allocator, 
+			// it is not taken from a temporary holding a copy of it
+			pointer tmp = this->M_allocate(n);
+			try
 			{
-				M_impl.deallocate(p, n);
+				lib_impl::uninitialized_fill_n_a(tmp, n, val, M_get_T_allocator());
+			}
+			catch(...)
+			{
+				M_deallocate(tmp, n);
+				throw;
 			}
+			M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
+			M_deallocate(this->M_impl.M_start,
+										this->M_impl.M_end - this->M_impl.M_start);
+			this->M_impl.M_start = tmp;
+			this->M_impl.M_finish = tmp + n;
+			this->M_impl.M_end = tmp + n;
 		}
-		// Allocator access
-		typedef A allocator_type;	
-		allocator_type&	
-		M_get_T_allocator()
+		else if (n > size())
 		{
-			return *static_cast<T_alloc_type*>(&this->M_impl);
+			lib_impl::fill(begin(), end(), val);
+			lib_impl::uninitialized_fill_n_a(this->M_impl.M_finish,
+																				n - size(),
+																				val,
+																				M_get_T_allocator());
+			this->M_impl.M_finish += n - size();
 		}
-		const allocator_type&	
-		M_get_T_allocator() const
+		else
 		{
-			return *static_cast<const T_alloc_type*>(&this->M_impl);
+			M_erase_at_end(lib_impl::fill_n(this->M_impl.M_start, n, val));
 		}
-		allocator_type
-		get_allocator() const	
+	}
+	
+	template <typename T,
+						typename A,
+						typename G>
+	template <typename... Args>
+	void
+	Vector<T,A,G>::	
+	M_insert_aux(iterator pos, 
+								Args&&... args)
+	{
+		if (this->M_impl.M_finish != this->M_impl.M_end)
 		{
-			return allocator_type(M_get_T_allocator());
+			this->M_impl.construct(this->M_impl.M_finish,
+															std::move(*(this->M_impl.M_finish - 1)));
+			++this->M_impl.M_finish;
+			lib_impl::move_backward(pos.base(),
+															this->M_impl.M_finish - 2,
+															this->M_impl.M_finish - 1);
+			*pos = T(std::forward<Args>(args)...);
 		}
-		//
-		Vector_base(std::size_t n, 
-								const allocator_type& a)	
-			: M_impl(a)
+		else if (Base::M_use_reallocate() && pos == end())
 		{
-			// allocate memory
-			this->M_impl.M_start = this->M_allocate(n);
-			this->M_impl.M_finish = this->M_impl.M_start;
-			this->M_impl.M_end = this->M_impl.M_start + n;
+			// arguments may refer to the storage being grown
+			value_type tmp(std::forward<Args>(args)...);
+			if (M_reallocate_append(size_type(1), "Vector::M_insert_aux length error"))
+			{
+				this->M_impl.construct(this->M_impl.M_finish, std::move(tmp));
+				++this->M_impl.M_finish;
+			}
+			else
+			{
+				M_realloc_insert(pos, std::move(tmp));
+			}
 		}
-		Vector_base(std::size_t n)
-			: Vector_base(n, get_allocator())
+		else
 		{
+			M_realloc_insert(pos, std::forward<Args>(args)...);
 		}
-		Vector_base()
-			: Vector_base(T(), get_allocator())
+	}	
+	template <typename T,
+						typename A,
+						typename G>
+	template <typename... Args>
+	void
+	Vector<T,A,G>::	
+	M_realloc_insert(iterator pos, 
+										Args&&... args)
+	{
 		{
+			size_type len = M_check_len(size_type(1), "Vector::M_insert_aux length error");
+			const size_type elems_before = pos - begin();
+			pointer new_start(this->M_allocate_at_least(len));
+			pointer new_finish(new_start);
+			try
+			{
+				this->M_impl.construct(new_start + elems_before,
+																std::forward<Args>(args)...);
+				new_finish = 0;
+				new_finish = M_relocate(this->M_impl.M_start,
+																pos.base(),
+																new_start);
+				++new_finish;
+				new_finish = M_relocate(pos.base(),
+																this->M_impl.M_finish,
+																new_finish);
+			}
+			catch(...)
+			{
+				if (!new_finish)
+				{
+					this->M_impl.destroy(new_start + elems_before);
+				}
+				else
+				{
+					M_destroy(new_start, new_finish);
+				}
+				M_deallocate(new_start, len);
+				throw std::runtime_error{"Move initialization failed"};											
+			}
+			M_destroy_relocated(this->M_impl.M_start, this->M_impl.M_finish);
+			M_deallocate(this->M_impl.M_start,
+										this->M_impl.M_end - this->M_impl.M_start);
+			this->M_impl.M_start = new_start;
+			this->M_impl.M_finish = new_finish;
+			this->M_impl.M_end = new_start + len;
 		}
-		Vector_base(const allocator_type& a)
-			: Vector_base(T(), a)
+	}	
+	template <typename T,
+						typename A,
+						typename G>
+	void
+	Vector<T,A,G>::
+	M_fill_insert(iterator pos, 
+								size_type n, 
+								const value_type& val)
+	{
+		if (n != 0)
 		{
+			if (size_type(this->M_impl.M_end
+										- this->M_impl.M_finish) >= n)
+			{
+				value_type val_copy = val;
+				const size_type elems_after = end() - pos;
+				pointer old_finish(this->M_impl.M_finish);
+				if (elems_after > n)
+				{
+					lib_impl::uninitialized_move_a(this->M_impl.M_finish - n,
+																					this->M_impl.M_finish,
+																					this->M_impl.M_finish,
+																					M_get_T_allocator());
+					this->M_impl.M_finish += n;
+					lib_impl::move_backward(pos.base(), old_finish - n, old_finish);
+					lib_impl::fill(pos.base(), pos.base() + n, val_copy);
+				}
+				else
+				{
+					lib_impl::uninitialized_fill_n_a(this->M_impl.M_finish,
+																						n - elems_after,
+																						val_copy,
+																						M_get_T_allocator());
+					this->M_impl.M_finish += n - elems_after;
+					lib_impl::uninitialized_move_a(pos.base(), 
+																					old_finish,
+																					this->M_impl.M_finish,
+																					M_get_T_allocator());
+					this->M_impl.M_finish += elems_after;
+					lib_impl::fill(pos.base(), old_finish, val_copy);
+				}
+			}
+			else if (Base::M_use_reallocate() && pos == end() && !M_holds(val)
+								&& M_reallocate_append(n, "Vector::M_fill_insert length error"))
+			{
+				lib_impl::uninitialized_fill_n_a(this->M_impl.M_finish,
+																					n,
+																					val,
+																					M_get_T_allocator());
+				this->M_impl.M_finish += n;
+			}
+			else
+			{
+				size_type len = M_check_len(n, "Vector::M_fill_insert length error");
+				const size_type elems_before = pos - begin();
+				pointer new_start(this->M_allocate_at_least(len));
+				pointer new_finish(new_start);
+				try
+				{
+					lib_impl::uninitialized_fill_n_a(new_start + elems_before,
+																						n, 
+																						val,
+																						M_get_T_allocator());
+					new_finish = 0;
+					new_finish = M_relocate(this->M_impl.M_start,
+																	pos.base(),
+																	new_start);
+					new_finish += n;
+					new_finish = M_relocate(pos.base(),
+																	this->M_impl.M_finish,
+																	new_finish);
+				}
+				catch(...)
+				{
+					if (!new_finish)
+					{
+						M_destroy(new_start + elems_before,
+											new_start + elems_before + n);
+					}
+					else
+					{
+						M_destroy(new_start, new_finish);						
+					}
+					M_deallocate(new_start, len);
+					throw std::runtime_error{"Vector::M_fill_insert error"};						
+				}
+				M_destroy_relocated(this->M_impl.M_start, this->M_impl.M_finish);
+				M_deallocate(this->M_impl.M_start, this->M_impl.M_end - this->M_impl.M_start);
+				this->M_impl.M_start = new_start;
+				this->M_impl.M_finish = new_finish;
+				this->M_impl.M_end = new_start + len;
+			}
 		}
-		// No copy
-		Vector_base(const Vector_base&)	= delete;
-		Vector_base&
-		operator=(const Vector_base&) = delete;
-		// Allow move	
-		Vector_base(Vector_base&& other)
-			: M_impl(other.M_get_T_allocator())
+	}	
+	template <typename T,
+						typename A,
+						typename G>
+	template <typename ForwardIterator>
+	void
+	Vector<T,A,G>::
+	M_range_insert(iterator pos, 
+									ForwardIterator first,
+									ForwardIterator last,
+									type::forward_iterator_tag)
+	{
+		if (first != last)
 		{
-			this->M_impl.M_start = other.M_impl.M_start;
-			this->M_impl.M_finish = other.M_impl.M_finish;
-			this->M_impl.M_end = other.M_impl.M_end;
-			// stable state
-			other.M_impl.M_start = 0;
-			other.M_impl.M_finish = 0;
-			other.M_impl.M_end = 0;
+			const size_type n = lib_impl::distance(first, last);
+			if (size_type(this->M_impl.M_end
+										- this->M_impl.M_finish) >= n)
+			{
+				// one shift of the tail by n
+				const size_type elems_after = end() - pos;
+				pointer old_finish(this->M_impl.M_finish);
+				if (elems_after > n)
+				{
+					lib_impl::uninitialized_move_a(this->M_impl.M_finish - n,
+																					this->M_impl.M_finish,
+																					this->M_impl.M_finish,
+																					M_get_T_allocator());
+					this->M_impl.M_finish += n;
+					lib_impl::move_backward(pos.base(), old_finish - n, old_finish);
+					lib_impl::copy(first, last, pos);
+				}
+				else
+				{
+					ForwardIterator mid = first;
+					lib_impl::advance(mid, elems_after);
+					M_copy_initialize(mid, last, this->M_impl.M_finish);
+					this->M_impl.M_finish += n - elems_after;
+					lib_impl::uninitialized_move_a(pos.base(), 
+																					old_finish,
+																					this->M_impl.M_finish,
+																					M_get_T_allocator());
+					this->M_impl.M_finish += elems_after;
+					lib_impl::copy(first, mid, pos);
+				}
+			}
+			else if (Base::M_use_reallocate() && pos == end()
+								&& M_reallocate_append(n, "Vector::M_range_insert length error"))
+			{
+				this->M_impl.M_finish = M_copy_initialize(first, 
+																										last, 
+																										this->M_impl.M_finish);
+			}
+			else
+			{
+				// one reallocation
+				size_type len = M_check_len(n, "Vector::M_range_insert length error");
+				const size_type elems_before = pos - begin();
+				pointer new_start(this->M_allocate_at_least(len));
+				pointer new_finish(new_start);
+				try
+				{
+					M_copy_initialize(first, last, new_start + elems_before);
+					new_finish = 0;
+					new_finish = M_relocate(this->M_impl.M_start,
+																	pos.base(),
+																	new_start);
+					new_finish += n;
+					new_finish = M_relocate(pos.base(),
+																	this->M_impl.M_finish,
+																	new_finish);
+				}
+				catch(...)
+				{
+					if (!new_finish)
+					{
+						M_destroy(new_start + elems_before,
+											new_start + elems_before + n);
+					}
+					else
+					{
+						M_destroy(new_start, new_finish);						
+					}
+					M_deallocate(new_start, len);
+					throw std::runtime_error{"Vector::M_range_insert error"};						
+				}
+				M_destroy_relocated(this->M_impl.M_start, this->M_impl.M_finish);
+				M_deallocate(this->M_impl.M_start, this->M_impl.M_end - this->M_impl.M_start);
+				this->M_impl.M_start = new_start;
+				this->M_impl.M_finish = new_finish;
+				this->M_impl.M_end = new_start + len;
+			}
 		}
-		Vector_base&
-		operator=(Vector_base&& other)
+	}
+	template <typename T,
+						typename A,
+						typename G>
+	void
+	Vector<T,A,G>::
+	reserve(size_type n)	
+	{
+		if (n > this->max_size())
 		{
-			std::swap(M_impl.M_start,other.M_impl.M_start);
-			std::swap(M_impl.M_finish,other.M_impl.M_finish);
-			std::swap(M_impl.M_end,other.M_impl.M_end);	
-			return *this;					
+			throw std::runtime_error{"Vector::reserve length error"};	
 		}
-		~Vector_base()
+		size_type len = n;
+		if (this->capacity() < n && !this->M_reallocate(len))
 		{
-			M_deallocate(this->M_impl.M_start, 
-										this->M_impl.M_end - this->M_impl.M_start);										
+			const size_type old_size = size();
+			pointer tmp = M_allocate_and_relocate(n,
+																						this->M_impl.M_start,
+																						this->M_impl.M_finish);
+			M_destroy_relocated(this->M_impl.M_start, this->M_impl.M_finish);
+			M_deallocate(this->M_impl.M_start,
+										this->M_impl.M_end - this->M_impl.M_start);
+			this->M_impl.M_start = tmp;
+			this->M_impl.M_finish = tmp + old_size;
+			this->M_impl.M_end = this->M_impl.M_start + n;
 		}
+	}
+	
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator==(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return (lhs.size() == rhs.size()
+						&& lib_impl::equal(lhs.begin(), lhs.end(), rhs.begin()));
+	}
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator!=(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return (!(lhs == rhs));
+	}	
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator<(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return lib_impl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),rhs.end());
+	}
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator>(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return (rhs < lhs);
+	}	
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator<=(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return (!(rhs < lhs));
+	}	
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	bool
+	operator>=(const Vector<T, A, G>& lhs, 
+							const Vector<T, A, G>& rhs)
+	{
+		return (!(lhs < rhs));
+	}	
+	template<typename T, 
+						typename A,
+						typename G>
+	inline
+	void
+	swap(Vector<T, A, G>& one, Vector<T, A, G>& two)
+	{
+		one.swap(two);
+	}					
+		// change implementation details
+		// change reverse iterator
+	template <typename T,
+						typename A=std::allocator<T>>
+	class
+	VectorB
+		: public Vector<T,A>
+	{
+		using Base											= Vector<T,A>;
+		public: 
+			using value_type							= typename Base::value_type;
+			using pointer									= typename Base::pointer;
+			using const_pointer						= typename Base::const_pointer;
+			using reference								= typename Base::reference;
+			using const_reference					= typename Base::const_reference;	
+			using iterator								= typename Base::iterator;	
+			using const_iterator					= typename Base::const_iterator;	
+			using reverse_iterator				= std::reverse_iterator<iterator>;	
+			using const_reverse_iterator	= std::reverse_iterator<const_iterator>;				
 	};
 	//---
-	// Vector
-	
-	template <typename T, 
-						typename A>
+	// SmallVector
+	// Up to N elements are stored inside the object,
+	// the allocator A is only used once they do not fit.
+	// Storage is never empty, capacity() is at least N.
+	template <typename T,
+						std::size_t N,
+						typename A = lib_impl::Allocator<T>,
+						typename G = lib_impl::Growth_double>
 	class
-	Vector
+	SmallVector
 		// AUTOSAR Rule A10-0-2
-		// Membership or non-public inheritance shall be used to implement “has-a” relationship.
-		: protected Vector_base<T, A>
-	{			
+		// Inline storage cannot be handed over like Vector storage,
+		// so SmallVector is implemented in terms of Vector but is not one.
+		: protected Vector<T, lib_impl::Inline_allocator<T, N, A>, G>
+	{
 		// Private implementation details
-      using Alloc_value_type					= typename A::value_type; 
-      using Base											= Vector_base<T, A>;
-      using T_alloc_type							= typename Base::T_alloc_type;
-      template <typename U>
-      using Iter											= lib_impl::Normal_iterator<U,Vector>;
-      template <typename U>
-      using Reverse_iter							= lib_impl::Reverse_iterator<U>;	
-		
-		// Concept requirements 
-      // MISRA C++
-      // Rule 16–0–4
-      // Function-like macros shall not be defined.
-      // used inline functions instead for safer type checking of parameters.
+      using Inline_alloc_type					= lib_impl::Inline_allocator<T, N, A>;
+      using Base											= Vector<T, Inline_alloc_type, G>;
 
 			// Concept requirements 
-			typedef Iter<typename T_alloc_type::pointer> iter;
-      typedef Vector<T,A> Vector_t; 
-        // Member functions of a local class are implicitly inline functions.
+      typedef SmallVector<T,N,A,G> SmallVector_t; 
       static
       void 
       M_constraints() 
       {
-        // Requirements for element type T used by Vector
-        type::__function_requires< type::SGIAssignableConcept<T> >();
-        type::__function_requires< type::RandomAccessIteratorConcept<iter> >();
-        // Requirements for the container Vector
-        type::__function_requires< type::ContainerConcept<Vector_t> >(); 
-        type::__function_requires< type::AllocatorAwareContainerConcept<Vector_t> >(); 
-        type::__function_requires< type::ReversibleContainerConcept<Vector_t> >();   
-        type::__function_requires< type::SequenceContainerConcept<Vector_t> >();   
-
+        // Requirements for the container SmallVector
+        type::__function_requires< type::ContainerConcept<SmallVector_t> >(); 
+        type::__function_requires< type::AllocatorAwareContainerConcept<SmallVector_t> >(); 
+        type::__function_requires< type::ReversibleContainerConcept<SmallVector_t> >();   
+        type::__function_requires< type::SequenceContainerConcept<SmallVector_t> >();   
       }
       typedef type::_class_requires< &M_constraints > _concept_requirements_t;	
 
 		public:
-			using value_type							= T;
-			using pointer									= typename T_alloc_type::pointer;
-			using const_pointer						= typename T_alloc_type::const_pointer;
-			using reference								= typename T_alloc_type::reference;
-			using const_reference					= typename T_alloc_type::const_reference;	
-			using iterator								= Iter<pointer>;	
-			using const_iterator					= Iter<const_pointer>;	
-			using reverse_iterator				= Reverse_iter<iterator>;
-			using const_reverse_iterator	= Reverse_iter<const_iterator>;
-			using size_type								= std::size_t;
-			using difference_type					= std::ptrdiff_t;
+			using value_type							= typename Base::value_type;
+			using pointer									= typename Base::pointer;
+			using const_pointer						= typename Base::const_pointer;
+			using reference								= typename Base::reference;
+			using const_reference					= typename Base::const_reference;	
+			using iterator								= typename Base::iterator;	
+			using const_iterator					= typename Base::const_iterator;	
+			using reverse_iterator				= typename Base::reverse_iterator;
+			using const_reverse_iterator	= typename Base::const_reverse_iterator;
+			using size_type								= typename Base::size_type;
+			using difference_type					= typename Base::difference_type;
 			using allocator_type					= A;
+			using growth_policy						= G;
+			using subscript_policy				= typename Base::subscript_policy;
+			static constexpr size_type inline_capacity = N;
 
 			explicit
-			Vector(size_type n, 
-							const value_type& val = value_type(),
-							const allocator_type& a = allocator_type())
-					// alloacate memory
-				: Base(n, a)
+			SmallVector(size_type n, 
+									const value_type& val,
+									const allocator_type& a = allocator_type())
+				: Base(n, val, Inline_alloc_type(a))
 			{
-				// initialize
-				M_fill_initialize(n, val);
+				M_claim_inline();
 			}
-			Vector()
-				: Vector(size_type(0), value_type(0), allocator_type())
+			SmallVector(size_type n, 
+									Default_init_t,
+									const allocator_type& a = allocator_type())
+				: Base(n, default_init, Inline_alloc_type(a))
 			{
+				M_claim_inline();
 			}
-			Vector(const allocator_type& a)
-				: Vector(size_type(0), value_type(0), a)
+			SmallVector()
+				: SmallVector(allocator_type())
+			{
+			}
+			SmallVector(const allocator_type& a)
+				: Base(Inline_alloc_type(a))
 			{
+				M_claim_inline();
 			}	
 			explicit
-			Vector(size_type n)		
-				: Vector(n, value_type(0), allocator_type())
+			SmallVector(size_type n)		
+				: SmallVector(n, value_type(), allocator_type())
 			{
 			}
       template < class InputIt >
-      Vector(InputIt first, 
-              InputIt last,
-              const A& alloc = allocator_type())
-        : Base(alloc)
+      SmallVector(InputIt first, 
+              		InputIt last,
+              		const A& alloc = allocator_type())
+        : Base(first, last, Inline_alloc_type(alloc))
       {
-        typedef typename std::is_integral<InputIt>::type Integral;
-        M_initialize_dispatch(first, last, Integral());
+				M_claim_inline();
       }
-      // AUTOSAR C++
-      // Compliant Rule A12-0-1
-      // “the rule of five”
-      // five special member functions
-      // - copy and move constructor
-      // - copy and move assignment
-      // - destructor
-			Vector(const Vector& other)	
-				: Base(other.size(), other.M_get_T_allocator())	
-			{
-				this->M_impl.M_finish = M_copy_initialize(other.begin(), 
-																										other.end(), 
-																										this->M_impl.M_start);
-			}
-			Vector&
-			operator=(const Vector& other);
-			Vector(Vector&& other)
-				: Base(std::move(other))	
-			{
-			}	
-			Vector&
-			operator=(Vector&& other)
-			{
-				this->clear();
-				this->swap(other);
-				return *this;
-			}					
-			~Vector()
-			{
-				M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
-			}
-      //
-      Vector(const Vector& other, 
-              const A& alloc)
-				: Base(other.size(), alloc)	
-			{
-				this->M_impl.M_finish = lib_impl::uninitialized_copy_a(other.begin(), 
-																										            other.end(), 
-																										            this->M_impl.M_start,
-                                                                alloc);
-			}
-			Vector(lib_impl::initializer_list<value_type> l)
-				: Base(l.size())
+			SmallVector(lib_impl::initializer_list<value_type> l)
+				: Base(l)
 			{
-				this->assign(l.begin(), l.end());
+				M_claim_inline();
 			}			
-			Vector&
-			operator=(lib_impl::initializer_list<value_type> l)
-			{
-				this->assign(l.begin(), l.end());
-				return *this;
-			}
-			iterator
-			begin()
-			{ 
-				return iterator(this->M_impl.M_start); 
-			}
-			const_iterator
-			begin() const
-			{ 
-				return const_iterator(this->M_impl.M_start); 
-			}
-			iterator
-			end()
-			{ 
-				return iterator(this->M_impl.M_finish); 
-			}	
-			const_iterator
-			end() const
-			{ 
-				return const_iterator(this->M_impl.M_finish); 
-			}
-			reverse_iterator
-			rbegin()
-			{ 
-				return reverse_iterator(end()); 
-			}
-			const_reverse_iterator
-			rbegin() const
-			{ 
-				return const_reverse_iterator(end()); 
-			}
-			reverse_iterator
-			rend()
-			{ 
-				return reverse_iterator(begin()); 
-			}		
-			const_reverse_iterator
-			rend() const
-			{ 
-				return const_reverse_iterator(begin()); 
-			}	
-			size_type
-			size() const
-			{ 
-				return size_type(this->M_impl.M_finish - this->M_impl.M_start); 
-			}	
-			size_type
-			max_size() const
-			{ 
-				return M_get_T_allocator().max_size(); 
-			}	
-			size_type
-			capacity()
-			{ 
-				return size_type(this->M_impl.M_end - this->M_impl.M_start);	
-			}						
-			void
-			swap(Vector& other)	
-			{
-				std::swap(this->M_impl.M_start, other.M_impl.M_start);
-				std::swap(this->M_impl.M_finish, other.M_impl.M_finish);
-				std::swap(this->M_impl.M_end, other.M_impl.M_end);
-				std::__alloc_swap<T_alloc_type>::_S_do_it(M_get_T_allocator(), other.M_get_T_allocator());
-			}
-			void
-			clear()
-			{
-				M_erase_at_end(this->M_impl.M_start);
-			}
-			bool
-			empty() const
-			{
-				return bool(begin() == end());
-			}
-			reference
-			operator[](size_type n)
-			{
-				M_range_check(n);			
-				return *(this->M_impl.M_start + n); 
-			}
-			const_reference
-			operator[](size_type n) const
-			{
-				M_range_check(n);			
-				return *(this->M_impl.M_start + n); 
-			}
-			reference
-			at(size_type n)
-			{
-				M_range_check(n);
-				return (*this)[n];
-			}	
-			const_reference
-			at(size_type n) const
-			{
-				M_range_check(n);
-				return (*this)[n];
-			}
-			reference
-			front()
-			{
-				return (*begin());
-			}	
-			const_reference
-			front() const
+			SmallVector(const SmallVector& other)	
+				: Base(other)
 			{
-				return (*begin());
+				M_claim_inline();
 			}
-			reference
-			back()
-			{
-				return (*(end() - 1));
-			}	
-			const_reference
-			back() const
-			{
-				return (*(end() - 1));
-			}	
-			pointer
-			data()
+			SmallVector(const SmallVector& other, 
+									const A& alloc)	
+				: Base(other, Inline_alloc_type(alloc))
 			{
-				return std::addressof(front());
-			}	
-			const_pointer
-			data() const
+				M_claim_inline();
+			}
+			SmallVector(SmallVector&& other)	
+				: SmallVector(std::move(other), other.get_allocator())
 			{
-				return std::addressof(front());
 			}
-			void
-			push_back(const_reference val)	
+			SmallVector(SmallVector&& other, 
+									const A& alloc)	
+				: Base(Inline_alloc_type(alloc))
 			{
-				if (this->M_impl.M_finish != this->M_impl.M_end)
-				{
-					this->M_impl.construct(this->M_impl.M_finish, val);
-					++this->M_impl.M_finish;
-				}
-				else
-				{
-					M_insert_aux(end(), val);
-				}
+				M_claim_inline();
+				M_take(other);
 			}
-			void
-			push_back(value_type&& val)	
+			SmallVector&
+			operator=(const SmallVector& other)
 			{
-				emplace_back(std::move(val));
+				Base::operator=(other);
+				return *this;
 			}
-			
-			template <typename... Args>	
-			void
-			emplace_back(Args&&... args)
+			SmallVector&
+			operator=(SmallVector&& other)
 			{
-				if (this->M_impl.M_finish != this->M_impl.M_end)
-				{
-					this->M_impl.construct(this->M_impl.M_finish,
-																	std::forward<Args>(args)...);
-					++this->M_impl.M_finish;
-				}
-				else
+				if (&other != this)
 				{
-					M_insert_aux(end(), std::forward<Args>(args)...);
+					M_take(other);
 				}
-			}	
-			void
-			pop_back()
+				return *this;
+			}
+			SmallVector&
+			operator=(lib_impl::initializer_list<value_type> l)
 			{
-				--this->M_impl.M_finish;
-				this->M_impl.destroy(this->M_impl.M_finish);
-			}								
-			void
-			assign(size_type n, 
-							const value_type& val)	
+				this->assign(l.begin(), l.end());
+				return *this;
+			}
+			using Base::begin;
+			using Base::end;
+			using Base::rbegin;
+			using Base::rend;
+			using Base::size;
+			using Base::max_size;
+			using Base::capacity;
+			using Base::clear;
+			using Base::empty;
+			using Base::operator[];
+			using Base::unchecked_at;
+			using Base::at;
+			using Base::front;
+			using Base::back;
+			using Base::data;
+			using Base::push_back;
+			using Base::emplace_back;
+			using Base::pop_back;
+			using Base::assign;
+			using Base::insert;
+			using Base::emplace;
+			using Base::erase;
+			using Base::reserve;
+			using Base::resize;
+			using Base::resize_default_init;
+
+			allocator_type
+			get_allocator() const
 			{
-				M_fill_assign(n, val);
+				return this->M_get_T_allocator().upstream();
 			}
-			void
-			assign(const std::initializer_list<value_type> l)
+			// True while the elements live inside the object
+			bool
+			is_inline() const
 			{
-				this->assign(l.begin(), l.end());
+				return (this->M_impl.M_start == this->M_get_T_allocator().inline_data());
 			}
-			template <typename InputIterator>	
+			// Heap storage is exchanged, inline elements are moved
 			void
-			assign(InputIterator first,
-							InputIterator last)
+			swap(SmallVector& other)
 			{
-				pointer curr(this->M_impl.M_start);
-				for (; first != last && curr != this->M_impl.M_finish; ++curr, ++first)
-					*curr = *first;
-				if (first == last)
+				if (!is_inline() && !other.is_inline())
 				{
-					M_erase_at_end(curr);
+					this->M_swap_data(other);
 				}
 				else
 				{
-					insert(end(), first, last);
+					SmallVector tmp(std::move(other));
+					other = std::move(*this);
+					*this = std::move(tmp);
 				}
 			}
-			template <typename InputIterator>	
+		private:
+			// Inline storage becomes the storage of an empty object,
+			// or its full size is made available once it is used.
 			void
-			insert(iterator pos, 
-			 				InputIterator first,	
-			 				InputIterator last)
+			M_claim_inline()
 			{
-				M_range_insert(pos, first, last); 	
+				if (!this->M_impl.M_start)
+				{
+					this->M_impl.M_start = this->M_allocate(N);
+					this->M_impl.M_finish = this->M_impl.M_start;
+				}
+				if (is_inline())
+				{
+					this->M_impl.M_end = this->M_impl.M_start + N;
+				}
 			}
-			iterator
-			insert(iterator pos, 
-							const value_type& val)
+			// Takes the elements of other, other is left empty
+			void
+			M_take(SmallVector& other)
 			{
-				const size_type n = pos - begin();
-				if (this->M_impl.M_finish != this->M_impl.M_end
-							&& pos == end()) 
+				if (!other.is_inline() 
+							&& other.M_get_T_allocator().upstream() == this->M_get_T_allocator().upstream())
 				{
-					this->M_impl.construct(this->M_impl.M_finish, val);
-					++this->M_impl.M_finish;
+					this->clear();
+					this->M_deallocate(this->M_impl.M_start, 
+															this->M_impl.M_end - this->M_impl.M_start);
+					this->M_impl.M_start = other.M_impl.M_start;
+					this->M_impl.M_finish = other.M_impl.M_finish;
+					this->M_impl.M_end = other.M_impl.M_end;
+					other.M_impl.M_start = 0;
+					other.M_impl.M_finish = 0;
+					other.M_impl.M_end = 0;
+					other.M_claim_inline();
 				}
 				else
 				{
-					if (this->M_impl.M_finish != this->M_impl.M_end)
-					{
-						value_type val_copy = val;
-						M_insert_aux(pos, std::move(val_copy));
-					}
-					else
-					{
-						M_insert_aux(pos, val);
-					}
+					this->M_assign_move(other.M_impl.M_start, other.M_impl.M_finish);
+					other.clear();
 				}
-				return iterator(this->M_impl.M_start + n);
-			} 			
-			iterator
-			insert(iterator pos, 
-							value_type&& val)
-			{
-				return emplace(pos, std::move(val)); 
-			} 
-			void
-			insert(iterator pos, 
-							std::initializer_list<value_type> l)
-			{
-				this->insert(pos, l.begin(), l.end());
 			}
-			void
-			insert(iterator pos, 
-							size_type n, 
-							const value_type& val)
+	};
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator==(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return (lhs.size() == rhs.size()
+						&& lib_impl::equal(lhs.begin(), lhs.end(), rhs.begin()));
+	}
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator!=(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return (!(lhs == rhs));
+	}	
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator<(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return lib_impl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),rhs.end());
+	}
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator>(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return (rhs < lhs);
+	}	
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator<=(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return (!(rhs < lhs));
+	}	
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	bool
+	operator>=(const SmallVector<T, N, A, G>& lhs, 
+							const SmallVector<T, N, A, G>& rhs)
+	{
+		return (!(lhs < rhs));
+	}	
+	template<typename T, 
+						std::size_t N,
+						typename A,
+						typename G>
+	inline
+	void
+	swap(SmallVector<T, N, A, G>& one, 
+				SmallVector<T, N, A, G>& two)
+	{
+		one.swap(two);
+	}
+	
+	// Persistent Vectors
+	// The root Vector of a Mapped_file, empty when there is none.
+	// Its elements are the mapped pages of the file, nothing is read
+	// or copied until they are used.
+	template <typename T, 
+						typename G = lib_impl::Growth_double>
+	Vector<T, lib_impl::File_allocator<T>, G>
+	open_vector(lib_impl::Mapped_file& file)
+	{
+		typedef Vector<T, lib_impl::File_allocator<T>, G> Vector_t;
+		const lib_impl::File_allocator<T> a(file);
+		if (!file.root())
+		{
+			return Vector_t(a);
+		}
+		if (file.root_element_size() != sizeof(T))
+		{
+			throw std::runtime_error{"open_vector element size mismatch"};
+		}
+		return Vector_t(adopt, static_cast<T*>(file.root()), 
+										file.root_size(), file.root_capacity(), a);
+	}
+	// Records v as the root of file and writes it to disk, 
+	// for open_vector after a restart. Blocks v left behind while
+	// growing are dropped when the file is opened again.
+	// Throws unless v was built in file.
+	template <typename T, 
+						typename G>
+	void
+	sync_vector(lib_impl::Mapped_file& file, 
+							Vector<T, lib_impl::File_allocator<T>, G>& v)
+	{
+		const T* p = (v.capacity() ? std::addressof(*v.begin()) : 0);
+		if (v.get_allocator().file() != &file 
+				|| (p && !file.owns(p, v.capacity() * sizeof(T))))
+		{
+			throw std::runtime_error{"sync_vector Vector is not in the file"};
+		}
+		file.set_root(p, v.size(), v.capacity(), sizeof(T));
+		file.sync();
+	}
+	
+	// Binary images of Vectors, see lib_impl::Binary_header
+	template <typename T, 
+						typename A,
+						typename G>
+	void
+	write_binary(int fd, 
+								const Vector<T, A, G>& v)
+	{
+		const T* p = (v.empty() ? 0 : std::addressof(*v.begin()));
+		lib_impl::write_binary(fd, lib_impl::make_binary_header(p, v.size()), p);
+	}
+	// Replaces the elements of v, read straight into its storage.
+	// v is left empty when the image is not valid.
+	template <typename T, 
+						typename A,
+						typename G>
+	void
+	read_binary(int fd, 
+							Vector<T, A, G>& v)
+	{
+		try
+		{
+			lib_impl::read_binary<T>(fd, 
+															[&v](std::size_t n) -> T*
+															{
+																v.clear();
+																v.resize_default_init(n);
+																return (n ? std::addressof(*v.begin()) : 0);
+															});
+		}
+		catch (...)
+		{
+			v.clear();
+			throw;
+		}
+	}
+	// Binary view
+	// Read-only elements of a binary image, in a buffer of the caller
+	// or in a file mapped privately, pages read on first use. 
+	// Nothing is parsed or copied; verify reads every byte once to
+	// check the checksum.
+	template <typename T>
+	class
+	Binary_view
+	{
+		public:
+			using value_type							= T;
+			using size_type								= std::size_t;
+			using const_reference					= const T&;
+			using const_pointer						= const T*;
+			using const_iterator					= const T*;
+
+			// buffer must outlive the view
+			Binary_view(const void* buffer, 
+									std::size_t bytes, 
+									bool verify = true)
+				: M_data(lib_impl::binary_elements<T>(buffer, bytes, M_size, verify))
 			{
-				M_fill_insert(pos, n, val);
 			}
-			template <typename... Args>
-			iterator
-			emplace(iterator pos, 
-								Args&&... args)
+			static
+			Binary_view
+			map(const char* path, 
+					bool verify = true)
 			{
-				const size_type n = pos - begin();
-				if (this->M_impl.M_finish != this->M_impl.M_end && pos == end())
+				const int fd = ::open(path, O_RDONLY);
+				struct stat st;
+				if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size == 0)
 				{
-					this->M_impl.construct(this->M_impl.M_finish,
-																	std::forward<Args>(args)...);
-					++this->M_impl.M_finish;
+					if (fd >= 0)
+						::close(fd);
+					throw std::runtime_error{"Binary_view cannot open file"};
 				}
-				else
+				const std::size_t bytes = std::size_t(st.st_size);
+				void* p = ::mmap(0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+				::close(fd);
+				if (p == MAP_FAILED)
 				{
-					M_insert_aux(pos, std::forward<Args>(args)...);
+					throw std::runtime_error{"Binary_view cannot map file"};
 				}
-				return iterator(this->M_impl.M_start + n);
-			}
-			iterator
-			erase(iterator pos)
-			{
-				if (pos + 1 != end())
+				try
 				{
-					std::move(pos + 1, end(), pos);				
+					Binary_view view(p, bytes, verify);
+					view.M_map = p;
+					view.M_map_bytes = bytes;
+					return view;
 				}
-				--this->M_impl.M_finish;
-				this->M_impl.destroy(this->M_impl.M_finish);
-				return pos;
-			}
-			iterator
-			erase(iterator first, 
-							iterator last)
-			{
-				if (first != last)
+				catch (...)
 				{
-					if (last != end())
-					{
-						std::move(last, end(), first);
-					}
-					M_erase_at_end(first.base() + (end() - last));
+					::munmap(p, bytes);
+					throw;
 				}
-				return first;
 			}
-			
-			void
-			reserve(size_type n);
-			
-			void
-			resize(size_type new_size, 
-							value_type val = value_type())
+			Binary_view(Binary_view&& other)
+			noexcept
+				: M_size(other.M_size), M_data(other.M_data), 
+					M_map(other.M_map), M_map_bytes(other.M_map_bytes)
 			{
-				if (new_size > size())
-				{
-					insert(end(), new_size - size(), val);
-				}
-				else if (new_size < size())
+				other.M_map = 0;
+			}
+			Binary_view(const Binary_view&) = delete;
+			Binary_view& operator=(const Binary_view&) = delete;
+			~Binary_view()
+			{
+				if (M_map)
 				{
-					M_erase_at_end(this->M_impl.M_start + new_size);
+					::munmap(M_map, M_map_bytes);
 				}
 			}
-		protected:
-			// Representation
-			using Base::M_impl;
-			using Base::M_allocate;
-			using Base::M_deallocate;
-			using Base::M_get_T_allocator;
-			using Base::get_allocator;
-			
-			// Member functions
-			void
-			M_fill_initialize(size_type n, 
-												const value_type& val)
+			const_pointer
+			data() const
+			noexcept
+			{
+				return M_data;
+			}
+			size_type
+			size() const
+			noexcept
+			{
+				return M_size;
+			}
+			bool
+			empty() const
+			noexcept
+			{
+				return (M_size == 0);
+			}
+			const_reference
+			operator[](size_type n) const
+			noexcept
 			{
-				lib_impl::uninitialized_fill_n_a(this->M_impl.M_start, n, val, M_get_T_allocator());
-				this->M_impl.M_finish = this->M_impl.M_end;
+				return M_data[n];
 			}
-			
-			template<typename InputIterator,
-								typename ForwardIterator>
-			ForwardIterator 
-			M_copy_initialize(InputIterator first, 
-														InputIterator last,
-														ForwardIterator	result)
+			const_iterator
+			begin() const
+			noexcept
 			{
-				return lib_impl::uninitialized_copy_a(first, 
-																							last, 
-																							result,
-																							M_get_T_allocator());			
+				return M_data;
 			}
-				
-			template<typename InputIterator>
-			void 
-			M_destroy(InputIterator first, 
-									InputIterator last)
+			const_iterator
+			end() const
+			noexcept
 			{
-				lib_impl::destroy_a(first,last,M_get_T_allocator());
+				return M_data + M_size;
 			}
-			
-			template<typename InputIterator, 
-								typename ForwardIterator>
-			ForwardIterator
-			M_copy(InputIterator first, 
-			 			InputIterator last,
-			 			ForwardIterator result)
-			{	
-				return lib_impl::copy(first,last,result);
+		private:
+			// set by the constructor of M_data
+			std::size_t M_size;
+			const T* M_data;
+			void* M_map{0};
+			std::size_t M_map_bytes{0};
+	};
+	
+	//---
+	// Concurrent_vector
+	// push_back and emplace_back may run on any number of threads at
+	// once. A slot is reserved with an atomic compare-exchange, in segments 
+	// which double in size and never move, so references to elements
+	// stay valid for the life of the container.
+	// An element is published once it and every element before it are
+	// constructed, whichever thread finishes last advances size(); 
+	// readers may use [0, size()) while others append.
+	// The element is built and its segment allocated before the slot
+	// is reserved, then moved in, so neither a throwing constructor nor
+	// a failed allocation leaves a hole that stops size().
+	// Racing threads may both allocate a missing segment, the loser
+	// frees its copy. Destruction and clear() are not concurrent.
+	template <typename T,
+						typename A = lib_impl::Allocator<T>>
+	class
+	Concurrent_vector
+	{
+			typedef typename A::template rebind<T>::other T_alloc_type;
+			typedef std::atomic<bool> Flag_type;
+			static_assert(std::is_nothrow_move_constructible<T>::value,
+										"Concurrent_vector elements are moved into their slot");
+		public:
+			using value_type							= T;
+			using allocator_type					= A;
+			using size_type								= std::size_t;
+			using difference_type					= std::ptrdiff_t;
+			using reference								= T&;
+			using const_reference					= const T&;
+			using pointer									= T*;
+			using const_pointer						= const T*;
+			using iterator								= lib_impl::Segment_iterator<Concurrent_vector, T>;
+			using const_iterator					= lib_impl::Segment_iterator<const Concurrent_vector, const T>;
+
+			// First segment of about 256 bytes
+			explicit
+			Concurrent_vector(const allocator_type& a = allocator_type())
+				: Concurrent_vector(256 / sizeof(T), a)
+			{
 			}
-				
-			template<typename ForwardIterator>
-			pointer
-			M_allocate_and_copy(size_type n,
-													ForwardIterator first, 
-													ForwardIterator last)	
+			// first_segment is rounded up to a power of two
+			explicit
+			Concurrent_vector(size_type first_segment, 
+												const allocator_type& a = allocator_type())
+				: M_alloc(a), M_shift(0), M_reserved(0), M_size(0)
 			{
-				pointer result = this->M_allocate(n);
-				try
+				while ((size_type(1) << M_shift) < first_segment)
 				{
-					M_copy_initialize(first, last, result);
-					return result;
+					++M_shift;
 				}
-				catch(...)
+				for (size_type k = 0; k != M_segments_max; ++k)
 				{
-					M_deallocate(result, n);
-					throw std::runtime_error{"Copy initialization failed"};											
+					M_segments[k].store(0, std::memory_order_relaxed);
 				}
 			}
-			
-			void
-			M_erase_at_end(pointer pos)
+			Concurrent_vector(const Concurrent_vector&) = delete;
+			Concurrent_vector& operator=(const Concurrent_vector&) = delete;
+			~Concurrent_vector()
 			{
-				M_destroy(pos, this->M_impl.M_finish);
-				this->M_impl.M_finish = pos;
+				clear();
+				for (size_type k = 0; k != M_segments_max; ++k)
+				{
+					T* seg = M_segments[k].load(std::memory_order_relaxed);
+					if (seg)
+					{
+						M_alloc.deallocate(seg, M_segment_alloc(k));
+					}
+				}
 			}
-			
-			void
-			M_fill_assign(size_type n, const value_type& val);
-			
-			template <typename InputIterator>
+			// Modifiers
+			// Return the element, which never moves
+			reference
+			push_back(const T& val)
+			{
+				return M_push(T(val));
+			}
+			reference
+			push_back(T&& val)
+			{
+				return M_push(std::move(val));
+			}
+			template <typename... Args>
+			reference
+			emplace_back(Args&&... args)
+			{
+				return M_push(T(std::forward<Args>(args)...));
+			}
+			// Destroys the elements, segments are kept
 			void
-			M_range_insert(iterator pos, 
-											InputIterator first,
-											InputIterator last)
+			clear()
+			noexcept
 			{
-				for (; first != last; ++first)
+				const size_type n = M_reserved.load(std::memory_order_acquire);
+				for (size_type i = 0; i != n; ++i)
 				{
-					pos = insert(pos, *first);
+					size_type k;
+					size_type off;
+					M_locate(i, k, off);
+					T* seg = M_segments[k].load(std::memory_order_relaxed);
+					if (seg && M_flags(seg, k)[off].exchange(false, std::memory_order_relaxed))
+					{
+						M_alloc.destroy(seg + off);
+					}
 				}
+				M_reserved.store(0, std::memory_order_relaxed);
+				M_size.store(0, std::memory_order_release);
 			}
-			
-			template <typename... Args>
-			void
-			M_insert_aux(iterator pos, 
-										Args&&... args);
-			
-			void
-			M_fill_insert(iterator pos, 
-										size_type n, 
-										const value_type& val);
-			
+			// Capacity
+			// Published elements
 			size_type
-			M_check_len(size_type n, 
-									const char* s) const
+			size() const
+			noexcept
 			{
-				if (max_size() - size() < n)
-					throw std::runtime_error{s};
-				const size_type len = size() + std::max(size(), n);
-				return ((len < size() || len > max_size()) ? max_size() : len);											
+				return M_size.load(std::memory_order_acquire);
 			}
-			
-			void
-			M_range_check(size_type n) const
+			bool
+			empty() const
+			noexcept
+			{
+				return (size() == 0);
+			}
+			size_type
+			capacity() const
+			noexcept
 			{
-				if (n >= this->size())
+				size_type n = 0;
+				for (size_type k = 0; k != M_segments_max; ++k)
 				{
-					throw std::runtime_error{"Vector::M_range_check"};
+					if (M_segments[k].load(std::memory_order_relaxed))
+					{
+						n += M_segment_size(k);
+					}
 				}
+				return n;
 			}
-      template <typename Integer>
-      void
-      M_initialize_dispatch(Integer n, 
-                              Integer value, 
-                              std::integral_constant<bool, true>)
-      {
-        this->M_impl.M_start = M_allocate(static_cast<size_type>(n));
-        this->M_impl.M_end = this->M_impl.M_start + static_cast<size_type>(n);
-        M_fill_initialize(static_cast<size_type>(n),value);
-      }
-
-      template <typename InputIt>
-      void
-      M_initialize_dispatch(InputIt first, 
-                              InputIt last,
-                              std::integral_constant<bool, false>)
-      {
-        typedef typename type::Iterator_traits<InputIt>::iterator_category 
-        IterCategory;
-        M_range_initialize(first, last, IterCategory());
-      } 
-      template <typename InputIt>
-      void
-      M_range_initialize(InputIt first,
-                          InputIt last, 
-                          type::input_iterator_tag)
-      {
-        for (; first != last; ++first)
-        {
-          push_back(*first);
-        }
-      }
-
-      template<typename ForwardIt>
-      void
-      M_range_initialize(ForwardIt first,
-                          ForwardIt last, 
-                          type::forward_iterator_tag)
-      {
-        const size_type n = std::distance(first, last);
-        this->M_impl.M_start = this->M_allocate(n);
-        this->M_impl.M_end = this->M_impl.M_start + n;
-        this->M_impl.M_finish = M_copy_initialize(first, last, this->M_impl.M_start);
-      }           
-	};
-	template <typename T,
-						typename A>
-	Vector<T,A>&
-	Vector<T,A>::
-	operator=(const Vector<T,A>& other)
-	{
-		// check for self copy	
-		if (&other != this)
-		{
-			const size_type len = other.size();
-			if (len > capacity())
+			// Element access, n below a size() already read
+			reference
+			operator[](size_type n)
+			noexcept
 			{
-				pointer tmp = M_allocate_and_copy(len, other.begin(),other.end());
-				M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
-				M_deallocate(this->M_impl.M_start,this->M_impl.M_end - this->M_impl.M_start);
-				this->M_impl.M_start = tmp;
-				this->M_impl.M_end = this->M_impl.M_start + len;
+				size_type k;
+				size_type off;
+				M_locate(n, k, off);
+				return M_segments[k].load(std::memory_order_acquire)[off];
 			}
-			else if (size() >= len)
+			const_reference
+			operator[](size_type n) const
+			noexcept
 			{
-				M_destroy(M_copy(other.begin(), other.end(), begin()),
-									end());
+				size_type k;
+				size_type off;
+				M_locate(n, k, off);
+				return M_segments[k].load(std::memory_order_acquire)[off];
 			}
-			else
+			reference
+			at(size_type n)
 			{
-				M_copy(other.M_impl.M_start, other.M_impl.M_start + size(), this->M_impl.M_start);
-				M_copy_initialize(other.M_impl.M_start + size(),
-														other.M_impl.M_finish,
-														this->M_impl.M_finish);
+				M_range_check(n);
+				return (*this)[n];
 			}
-			this->M_impl.M_finish = this->M_impl.M_start + len;
-		}
-		return *this;
-	}
-	
-	template <typename T,
-						typename A>
-	void
-	Vector<T,A>::
-	M_fill_assign(size_type n, 
-								const value_type& val)	
-	{
-		if (n > capacity())	
-		{
-			Vector tmp(n, val, M_get_T_allocator());
-			tmp.swap(*this);
-		}
-		else if (n > size())
-		{
-			lib_impl::fill(begin(), end(), val);
-			lib_impl::uninitialized_fill_n_a(this->M_impl.M_finish,
-																				n - size(),
-																				val,
-																				M_get_T_allocator());
-			this->M_impl.M_finish += n - size();
-		}
-		else
-		{
-			M_erase_at_end(lib_impl::fill_n(this->M_impl.M_start, n, val));
-		}
-	}
-	
-	template <typename T,
-						typename A>
-	template <typename... Args>
-	void
-	Vector<T,A>::	
-	M_insert_aux(iterator pos, 
-								Args&&... args)
-	{
-		if (this->M_impl.M_finish != this->M_impl.M_end)
-		{
-			this->M_impl.construct(this->M_impl.M_finish,
-															std::move(*(this->M_impl.M_finish - 1)));
-			++this->M_impl.M_finish;
-			lib_impl::move_backward(pos.base(),
-															this->M_impl.M_finish - 2,
-															this->M_impl.M_finish - 1);
-			*pos = T(std::forward<Args>(args)...);
-		}
-		else
-		{
-			const size_type len = M_check_len(size_type(1), "Vector::M_insert_aux length error");
-			const size_type elems_before = pos - begin();
-			pointer new_start(this->M_allocate(len));
-			pointer new_finish(new_start);
-			try
+			const_reference
+			at(size_type n) const
 			{
-				this->M_impl.construct(new_start + elems_before,
-																std::forward<Args>(args)...);
-				new_finish = 0;
-				new_finish = lib_impl::uninitialized_move_a(this->M_impl.M_start,
-																											pos.base(), 
-																											new_start,
-																											M_get_T_allocator());
-				++new_finish;
-				new_finish = lib_impl::uninitialized_move_a(pos.base(),
-																											this->M_impl.M_finish,
-																											new_finish,
-																											M_get_T_allocator());
+				M_range_check(n);
+				return (*this)[n];
 			}
-			catch(...)
+			// Iterators, end() is the size() at the time of the call
+			iterator
+			begin()
+			noexcept
 			{
-				if (!new_finish)
-				{
-					this->M_impl.destroy(new_start + elems_before);
-				}
-				else
-				{
-					M_destroy(new_start, new_finish);
-				}
-				M_deallocate(new_start, len);
-				throw std::runtime_error{"Move initialization failed"};											
+				return iterator(this, 0);
 			}
-			M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
-			M_deallocate(this->M_impl.M_start,
-										this->M_impl.M_end - this->M_impl.M_start);
-			this->M_impl.M_start = new_start;
-			this->M_impl.M_finish = new_finish;
-			this->M_impl.M_end = new_start + len;
-		}
-	}	
-	template <typename T,
-						typename A>
-	void
-	Vector<T,A>::
-	M_fill_insert(iterator pos, 
-								size_type n, 
-								const value_type& val)
-	{
-		if (n != 0)
-		{
-			if (size_type(this->M_impl.M_end
-										- this->M_impl.M_finish) >= n)
+			const_iterator
+			begin() const
+			noexcept
 			{
-				value_type val_copy = val;
-				const size_type elems_after = end() - pos;
-				pointer old_finish(this->M_impl.M_finish);
-				if (elems_after > n)
+				return const_iterator(this, 0);
+			}
+			iterator
+			end()
+			noexcept
+			{
+				return iterator(this, size());
+			}
+			const_iterator
+			end() const
+			noexcept
+			{
+				return const_iterator(this, size());
+			}
+			allocator_type
+			get_allocator() const
+			noexcept
+			{
+				return allocator_type(M_alloc);
+			}
+		private:
+			// Segment k holds 2^(M_shift + k) elements
+			static constexpr size_type M_segments_max = 64;
+
+			size_type
+			M_segment_size(size_type k) const
+			noexcept
+			{
+				return (size_type(1) << (M_shift + k));
+			}
+			// Elements then one ready flag per element, in T units
+			size_type
+			M_segment_alloc(size_type k) const
+			noexcept
+			{
+				const size_type n = M_segment_size(k);
+				return n + (n * sizeof(Flag_type) + sizeof(T) - 1) / sizeof(T);
+			}
+			Flag_type*
+			M_flags(T* seg, 
+							size_type k) const
+			noexcept
+			{
+				return reinterpret_cast<Flag_type*>(seg + M_segment_size(k));
+			}
+			// Segment k starts at index 2^M_shift * (2^k - 1)
+			void
+			M_locate(size_type i, 
+								size_type& k, 
+								size_type& off) const
+			noexcept
+			{
+				const size_type q = (i >> M_shift) + 1;
+				k = size_type(63 - __builtin_clzll(q));
+				off = i - (((size_type(1) << k) - 1) << M_shift);
+			}
+			T*
+			M_segment(size_type k)
+			{
+				T* seg = M_segments[k].load(std::memory_order_acquire);
+				if (seg)
 				{
-					lib_impl::uninitialized_move_a(this->M_impl.M_finish - n,
-																					this->M_impl.M_finish,
-																					this->M_impl.M_finish,
-																					M_get_T_allocator());
-					this->M_impl.M_finish += n;
-					std::move(pos.base(), old_finish - n, old_finish);
-					lib_impl::fill(pos.base(), pos.base() + n, val_copy);
+					return seg;
 				}
-				else
+				const size_type n = M_segment_size(k);
+				T* fresh = M_alloc.allocate(M_segment_alloc(k));
+				Flag_type* flags = M_flags(fresh, k);
+				for (size_type i = 0; i != n; ++i)
 				{
-					lib_impl::uninitialized_fill_n_a(this->M_impl.M_finish,
-																						n - elems_after,
-																						val_copy,
-																						M_get_T_allocator());
-					this->M_impl.M_finish += n - elems_after;
-					lib_impl::uninitialized_move_a(pos.base(), 
-																					old_finish,
-																					this->M_impl.M_finish,
-																					M_get_T_allocator());
-					this->M_impl.M_finish += elems_after;
-					lib_impl::fill(pos.base(), old_finish, val_copy);
+					::new(static_cast<void*>(flags + i)) Flag_type(false);
 				}
+				if (M_segments[k].compare_exchange_strong(seg, fresh, 
+																									std::memory_order_acq_rel,
+																									std::memory_order_acquire))
+				{
+					return fresh;
+				}
+				M_alloc.deallocate(fresh, M_segment_alloc(k));
+				return seg;
 			}
-			else
+			reference
+			M_push(T&& val)
 			{
-				const size_type len = M_check_len(n, "Vector::M_fill_insert length error");
-				const size_type elems_before = pos - begin();
-				pointer new_start(this->M_allocate(len));
-				pointer new_finish(new_start);
-				try
+				size_type i = M_reserved.load(std::memory_order_relaxed);
+				size_type k;
+				size_type off;
+				T* seg;
+				// may throw, nothing is reserved until the segment exists
+				do
 				{
-					lib_impl::uninitialized_fill_n_a(new_start + elems_before,
-																						n, 
-																						val,
-																						M_get_T_allocator());
-					new_finish = 0;
-					new_finish = lib_impl::uninitialized_move_a(this->M_impl.M_start,
-																												pos.base(),
-																												new_start,
-																												M_get_T_allocator());
-					new_finish += n;
-					new_finish = lib_impl::uninitialized_move_a(pos.base(),
-																												this->M_impl.M_finish,
-																												new_finish,
-																												M_get_T_allocator());
+					M_locate(i, k, off);
+					seg = M_segment(k);
 				}
-				catch(...)
+				while (!M_reserved.compare_exchange_weak(i, i + 1, std::memory_order_relaxed));
+				M_alloc.construct(seg + off, std::move(val));
+				M_flags(seg, k)[off].store(true);
+				M_publish();
+				return seg[off];
+			}
+			// Moves size() over every constructed element following it
+			void
+			M_publish()
+			noexcept
+			{
+				size_type n = M_size.load();
+				for (;;)
 				{
-					if (!new_finish)
+					size_type k;
+					size_type off;
+					M_locate(n, k, off);
+					T* seg = M_segments[k].load(std::memory_order_acquire);
+					if (!seg || !M_flags(seg, k)[off].load())
 					{
-						M_destroy(new_start + elems_before,
-											new_start + elems_before + n);
+						return;
 					}
-					else
+					// on failure n is the size another thread published
+					if (M_size.compare_exchange_weak(n, n + 1))
 					{
-						M_destroy(new_start, new_finish);						
+						++n;
 					}
-					M_deallocate(new_start, len);
-					throw std::runtime_error{"Vector::M_fill_insert error"};						
 				}
-				M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
-				M_deallocate(this->M_impl.M_start, this->M_impl.M_end - this->M_impl.M_start);
-				this->M_impl.M_start = new_start;
-				this->M_impl.M_finish = new_finish;
-				this->M_impl.M_end = new_start + len;
 			}
-		}
-	}	
-	template <typename T,
-						typename A>
+			void
+			M_range_check(size_type n) const
+			{
+				lib_impl::Range_checked::check(n, size());
+			}
+
+			T_alloc_type M_alloc;
+			size_type M_shift;
+			std::atomic<T*> M_segments[M_segments_max];
+			std::atomic<size_type> M_reserved;
+			std::atomic<size_type> M_size;
+	};
+
+	// Parallel algorithms
+	// Random access ranges are cut into chunks of grain elements, by
+	// default as many as fill chunk_bytes, and run on lib_impl::Fork_join.
+	// Deterministic reductions combine chunk results in chunk order, so
+	// the result depends on the grain only, not on the thread count.
+	// Scans are always deterministic.
+	class
+	Parallel_policy
+	{
+		public:
+			static constexpr std::size_t chunk_bytes = 32 * 1024;
+
+			constexpr
+			Parallel_policy() noexcept
+				: M_grain(0), M_deterministic(false)
+			{
+			}
+			// 0 selects cache sized chunks
+			constexpr
+			Parallel_policy
+			grain(std::size_t n) const
+			noexcept
+			{
+				return Parallel_policy(n, M_deterministic);
+			}
+			constexpr
+			Parallel_policy
+			deterministic(bool on = true) const
+			noexcept
+			{
+				return Parallel_policy(M_grain, on);
+			}
+			constexpr
+			bool
+			is_deterministic() const
+			noexcept
+			{
+				return M_deterministic;
+			}
+			template <typename T>
+			constexpr
+			std::size_t
+			grain_for() const
+			noexcept
+			{
+				return (M_grain ? M_grain 
+												: (sizeof(T) < chunk_bytes ? chunk_bytes / sizeof(T) : 1));
+			}
+		private:
+			constexpr
+			Parallel_policy(std::size_t n, 
+											bool on) noexcept
+				: M_grain(n), M_deterministic(on)
+			{
+			}
+
+			std::size_t M_grain;
+			bool M_deterministic;
+	};
+	constexpr Parallel_policy par{};
+
+	template <typename RandomIt, 
+							typename Function>
 	void
-	Vector<T,A>::
-	reserve(size_type n)	
+	for_each(const Parallel_policy& policy, 
+						RandomIt first, 
+						RandomIt last, 
+						Function f)
 	{
-		if (n > this->max_size())
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
 		{
-			throw std::runtime_error{"Vector::reserve length error"};	
-		}
-		if (this->capacity() < n)
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				f(first[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+	}
+	template <typename RandomIt, 
+							typename OutputIt,
+							typename UnaryOp>
+	OutputIt
+	transform(const Parallel_policy& policy, 
+						RandomIt first, 
+						RandomIt last, 
+						OutputIt result, 
+						UnaryOp op)
+	{
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
 		{
-			const size_type old_size = size();
-			pointer tmp = M_allocate_and_copy(n,
-																				std::move(this->M_impl.M_start),
-																				std::move(this->M_impl.M_finish));
-			M_destroy(this->M_impl.M_start, this->M_impl.M_finish);
-			M_deallocate(this->M_impl.M_start,
-										this->M_impl.M_end - this->M_impl.M_start);
-			this->M_impl.M_start = tmp;
-			this->M_impl.M_finish = tmp + old_size;
-			this->M_impl.M_end = this->M_impl.M_start + n;
-		}
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				result[i] = op(first[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+		return result + n;
 	}
-	
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator==(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename OutputIt,
+							typename BinaryOp>
+	OutputIt
+	transform(const Parallel_policy& policy, 
+						RandomIt1 first1, 
+						RandomIt1 last1, 
+						RandomIt2 first2, 
+						OutputIt result, 
+						BinaryOp op)
 	{
-		return (lhs.size() == rhs.size()
-						&& std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type;
+		const std::size_t n = std::size_t(last1 - first1);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		auto 
+		body = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			for (std::size_t i = c * grain; i != end; ++i)
+			{
+				result[i] = op(first1[i], first2[i]);
+			}
+		};
+		lib_impl::Fork_join::run((n + grain - 1) / grain, body);
+		return result + n;
 	}
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator!=(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+	template <typename RandomIt, 
+							typename T,
+							typename BinaryOp>
+	T
+	reduce(const Parallel_policy& policy, 
+					RandomIt first, 
+					RandomIt last, 
+					T init, 
+					BinaryOp op)
 	{
-		return (!(lhs == rhs));
-	}	
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator<(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last - first), 
+																policy.grain_for<Value_type>(), std::move(init), op,
+																[&](std::size_t i) -> T { return first[i]; });
+	}
+	template <typename RandomIt, 
+							typename T>
+	T
+	reduce(const Parallel_policy& policy, 
+					RandomIt first, 
+					RandomIt last, 
+					T init)
 	{
-		return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),rhs.end());
+		return lib::reduce(policy, first, last, std::move(init), 
+												[](T a, const T& b) -> T { return a + b; });
 	}
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator>(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+	template <typename RandomIt, 
+							typename T,
+							typename ReduceOp,
+							typename TransformOp>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt first, 
+										RandomIt last, 
+										T init, 
+										ReduceOp red,
+										TransformOp tr)
 	{
-		return (rhs < lhs);
-	}	
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator<=(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last - first), 
+																policy.grain_for<Value_type>(), std::move(init), red,
+																[&](std::size_t i) -> T { return tr(first[i]); });
+	}
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename T,
+							typename ReduceOp,
+							typename TransformOp>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt1 first1, 
+										RandomIt1 last1, 
+										RandomIt2 first2, 
+										T init, 
+										ReduceOp red,
+										TransformOp tr)
 	{
-		return (!(rhs < lhs));
-	}	
-	template<typename T, 
-						typename A>
-	inline
-	bool
-	operator>=(const Vector<T, A>& lhs, 
-							const Vector<T, A>& rhs)
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type;
+		return lib_impl::parallel_reduce(policy.is_deterministic(), std::size_t(last1 - first1), 
+																policy.grain_for<Value_type>(), std::move(init), red,
+																[&](std::size_t i) -> T { return tr(first1[i], first2[i]); });
+	}
+	// Inner product
+	template <typename RandomIt1, 
+							typename RandomIt2,
+							typename T>
+	T
+	transform_reduce(const Parallel_policy& policy, 
+										RandomIt1 first1, 
+										RandomIt1 last1, 
+										RandomIt2 first2, 
+										T init)
 	{
-		return (!(lhs < rhs));
-	}	
-	template<typename T, 
-						typename A>
-	inline
-	void
-	swap(Vector<T, A>& one, Vector<T, A>& two)
+		typedef typename type::Iterator_traits<RandomIt1>::value_type Value_type1;
+		typedef typename type::Iterator_traits<RandomIt2>::value_type Value_type2;
+		return lib::transform_reduce(policy, first1, last1, first2, std::move(init), 
+																	[](T a, const T& b) -> T { return a + b; },
+																	[](const Value_type1& a, const Value_type2& b) -> T { return a * b; });
+	}
+	// Two passes: chunk totals, then each chunk rescanned from the 
+	// combined totals of the chunks before it. result may be first.
+	template <typename RandomIt, 
+							typename OutputIt,
+							typename BinaryOp>
+	OutputIt
+	inclusive_scan(const Parallel_policy& policy, 
+									RandomIt first, 
+									RandomIt last, 
+									OutputIt result, 
+									BinaryOp op)
 	{
-		one.swap(two);
-	}					
-		// change implementation details
-		// change reverse iterator
-	template <typename T,
-						typename A=std::allocator<T>>
-	class
-	VectorB
-		: public Vector<T,A>
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		const std::size_t n = std::size_t(last - first);
+		const std::size_t grain = policy.grain_for<Value_type>();
+		const std::size_t chunks = (n + grain - 1) / grain;
+		if (chunks < 2 || lib_impl::Fork_join::slots(chunks) < 2)
+		{
+			// one pass
+			for (std::size_t i = 0; i != n; ++i)
+			{
+				result[i] = (i ? op(result[i - 1], first[i]) : first[i]);
+			}
+			return result + n;
+		}
+		// carry[c] holds the total of the chunks before c
+		std::unique_ptr<std::optional<Value_type>[]> carry(new std::optional<Value_type>[chunks]);
+		auto 
+		total = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = c * grain + grain;
+			Value_type acc = first[c * grain];
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = op(std::move(acc), first[i]);
+			}
+			carry[c + 1].emplace(std::move(acc));
+		};
+		// the last chunk total is not needed
+		lib_impl::Fork_join::run(chunks - 1, total);
+		for (std::size_t c = 2; c < chunks; ++c)
+		{
+			carry[c] = op(*carry[c - 1], std::move(*carry[c]));
+		}
+		auto 
+		scan = 
+		[&](std::size_t, std::size_t c)
+		{
+			const std::size_t end = (n - c * grain < grain ? n : c * grain + grain);
+			Value_type acc = (c ? op(*carry[c], first[c * grain]) : Value_type(first[0]));
+			result[c * grain] = acc;
+			for (std::size_t i = c * grain + 1; i != end; ++i)
+			{
+				acc = op(std::move(acc), first[i]);
+				result[i] = acc;
+			}
+		};
+		lib_impl::Fork_join::run(chunks, scan);
+		return result + n;
+	}
+	template <typename RandomIt, 
+							typename OutputIt>
+	OutputIt
+	inclusive_scan(const Parallel_policy& policy, 
+									RandomIt first, 
+									RandomIt last, 
+									OutputIt result)
 	{
-		using Base											= Vector<T,A>;
-		public: 
-			using value_type							= typename Base::value_type;
-			using pointer									= typename Base::pointer;
-			using const_pointer						= typename Base::const_pointer;
-			using reference								= typename Base::reference;
-			using const_reference					= typename Base::const_reference;	
-			using iterator								= typename Base::iterator;	
-			using const_iterator					= typename Base::const_iterator;	
-			using reverse_iterator				= std::reverse_iterator<iterator>;	
-			using const_reverse_iterator	= std::reverse_iterator<const_iterator>;				
-	};
-	
+		typedef typename type::Iterator_traits<RandomIt>::value_type Value_type;
+		return lib::inclusive_scan(policy, first, last, result, 
+																[](Value_type a, const Value_type& b) -> Value_type { return a + b; });
+	}
 }
 //---End lib
 //--- User code
@@ -2629,6 +9481,577 @@ helper
 	}
 	template <typename T>
 	using vector						= lib::Vector<T,lib_impl::Allocator<T>>;	
+
+	// Allocations left before Failing_allocator throws
+	inline
+	std::size_t&
+	alloc_budget()
+	{
+		static std::size_t budget = std::size_t(-1);
+		return budget;
+	}
+	// Throws BadAlloc once alloc_budget() runs out
+	template <typename T>
+	class
+	Failing_allocator : public lib_impl::Allocator<T>
+	{
+		public:
+			template <class T2>
+			struct
+			rebind
+			{
+				typedef Failing_allocator<T2> other; 
+			};
+			Failing_allocator() = default;
+			template <class T2>
+			Failing_allocator(const Failing_allocator<T2>&)
+			noexcept
+			{
+			}
+			T*
+			allocate(const std::size_t n)
+			{
+				if (alloc_budget() == 0)
+				{
+					throw lib_impl::BadAlloc{};
+				}
+				--alloc_budget();
+				return lib_impl::Allocator<T>::allocate(n);
+			}
+	};
+
+	// Trace file named by LIB_ALLOC_TRACE_FILE, CSV when it ends in .csv
+	void
+	start_alloc_trace()
+	{
+		const char* path = std::getenv("LIB_ALLOC_TRACE_FILE");
+		if (path)
+		{
+			const std::size_t len = std::strlen(path);
+			const bool csv = (len > 4 && std::strcmp(path + len - 4, ".csv") == 0);
+			if (!lib_impl::Alloc_trace::start(path, 
+																				csv ? lib_impl::Trace_format::csv 
+																						: lib_impl::Trace_format::binary))
+			{
+				std::cout << "Cannot trace allocations to " << path << '\n';
+			}
+		}
+	}
+	void
+	stop_alloc_trace()
+	{
+		using lib_impl::Alloc_event;
+		using lib_impl::Alloc_trace;
+		Alloc_trace::stop();
+		std::cout << "allocations: " 
+							<< Alloc_trace::count(Alloc_event::new_single) 
+									+ Alloc_trace::count(Alloc_event::new_array)
+							<< " deallocations: " 
+							<< Alloc_trace::count(Alloc_event::delete_single) 
+									+ Alloc_trace::count(Alloc_event::delete_sized)
+									+ Alloc_trace::count(Alloc_event::delete_array) 
+									+ Alloc_trace::count(Alloc_event::delete_array_sized)
+							<< " untraced: " << Alloc_trace::dropped() << '\n';
+	}
+	// Statistics of every allocator by name, when LIB_ALLOC_STATS_DUMP is set
+	void
+	dump_alloc_stats()
+	{
+		if (std::getenv("LIB_ALLOC_STATS_DUMP"))
+		{
+			lib_impl::Alloc_registry::dump(stdout);
+		}
+	}
+	
+	//--- Benchmarks
+	// 64 byte element, trivially copyable
+	struct
+	Bench_pod
+	{
+		std::uint64_t v[8];
+	};
+	inline
+	bool
+	operator==(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return std::memcmp(lhs.v, rhs.v, sizeof(lhs.v)) == 0;
+	}
+	inline
+	bool
+	operator<(const Bench_pod& lhs, 
+						const Bench_pod& rhs)
+	{
+		for (std::size_t i = 0; i != 8; ++i)
+		{
+			if (lhs.v[i] != rhs.v[i])
+			{
+				return lhs.v[i] < rhs.v[i];
+			}
+		}
+		return false;
+	}
+	inline
+	bool
+	operator!=(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return !(lhs == rhs);
+	}
+	inline
+	bool
+	operator>(const Bench_pod& lhs, 
+						const Bench_pod& rhs)
+	{
+		return rhs < lhs;
+	}
+	inline
+	bool
+	operator<=(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return !(rhs < lhs);
+	}
+	inline
+	bool
+	operator>=(const Bench_pod& lhs, 
+							const Bench_pod& rhs)
+	{
+		return !(lhs < rhs);
+	}
+	// Name, heap bytes owned by an element, i-th value, 
+	// emplace_back arguments and a key to sum
+	template <typename T>
+	struct
+	Bench_type;
+
+	template <>
+	struct
+	Bench_type<int>
+	{
+		static constexpr const char* name = "int";
+		static constexpr std::size_t heap_bytes = 0;
+
+		static
+		int
+		make(std::size_t i)
+		{
+			return int(i);
+		}
+		template <typename Vec>
+		static
+		void
+		emplace_back(Vec& v, 
+									std::size_t i)
+		{
+			v.emplace_back(int(i));
+		}
+		static
+		std::size_t
+		key(int x)
+		{
+			return std::size_t(x);
+		}
+	};
+	template <>
+	struct
+	Bench_type<Bench_pod>
+	{
+		static constexpr const char* name = "pod64";
+		static constexpr std::size_t heap_bytes = 0;
+
+		static
+		Bench_pod
+		make(std::size_t i)
+		{
+			return Bench_pod{{i, i, i, i, i, i, i, i}};
+		}
+		template <typename Vec>
+		static
+		void
+		emplace_back(Vec& v, 
+									std::size_t i)
+		{
+			v.emplace_back(make(i));
+		}
+		static
+		std::size_t
+		key(const Bench_pod& x)
+		{
+			return std::size_t(x.v[0]);
+		}
+	};
+	// Past the small string buffer, every element owns a heap block
+	template <>
+	struct
+	Bench_type<std::string>
+	{
+		static constexpr const char* name = "string";
+		// 24 characters and the terminator in a 32 byte malloc chunk
+		static constexpr std::size_t heap_bytes = 32;
+
+		static
+		std::string
+		make(std::size_t i)
+		{
+			return std::string(24, char('a' + i % 26));
+		}
+		template <typename Vec>
+		static
+		void
+		emplace_back(Vec& v, 
+									std::size_t i)
+		{
+			v.emplace_back(std::size_t(24), char('a' + i % 26));
+		}
+		static
+		std::size_t
+		key(const std::string& x)
+		{
+			return std::size_t(x[0]);
+		}
+	};
+	// One measurement: ns per element operation, heap bytes and
+	// allocations per run of ops element operations
+	struct
+	Bench_row
+	{
+		const char* container;
+		const char* type;
+		std::size_t size;
+		const char* op;
+		std::size_t ops;
+		double ns_per_op;
+		double bytes;
+		double allocations;
+	};
+	// Time, heap bytes and allocations between start() and stop()
+	class
+	Bench_meter
+	{
+		public:
+			Bench_meter()
+				: M_ns(0), M_bytes(0), M_allocations(0), 
+					M_start(), M_start_bytes(0), M_start_allocations(0)
+			{
+			}
+			void
+			start()
+			{
+				M_start_allocations = M_allocations_now();
+				M_start_bytes = lib_impl::Alloc_trace::bytes();
+				M_start = std::chrono::steady_clock::now();
+			}
+			void
+			stop()
+			{
+				auto now = std::chrono::steady_clock::now();
+				M_ns += std::chrono::duration<double, std::nano>(now - M_start).count();
+				M_bytes += lib_impl::Alloc_trace::bytes() - M_start_bytes;
+				M_allocations += M_allocations_now() - M_start_allocations;
+			}
+			double
+			ns() const
+			{
+				return M_ns;
+			}
+			std::uint64_t
+			bytes() const
+			{
+				return M_bytes;
+			}
+			std::uint64_t
+			allocations() const
+			{
+				return M_allocations;
+			}
+		private:
+			static
+			std::uint64_t
+			M_allocations_now()
+			{
+				using lib_impl::Alloc_event;
+				using lib_impl::Alloc_trace;
+				return Alloc_trace::count(Alloc_event::new_single) 
+								+ Alloc_trace::count(Alloc_event::new_array);
+			}
+
+			double M_ns;
+			std::uint64_t M_bytes;
+			std::uint64_t M_allocations;
+			std::chrono::steady_clock::time_point M_start;
+			std::uint64_t M_start_bytes;
+			std::uint64_t M_start_allocations;
+	};
+	// Runs without state to restore are timed together
+	struct
+	Bench_no_reset
+	{
+		void
+		operator()() const
+		{
+		}
+	};
+	template <typename Function>
+	void
+	bench_reps(std::size_t reps, 
+							Function& f, 
+							Bench_no_reset&, 
+							Bench_meter& meter)
+	{
+		meter.start();
+		for (std::size_t i = 0; i != reps; ++i)
+		{
+			f();
+		}
+		meter.stop();
+	}
+	// reset restores the state f changed, outside the measurement
+	template <typename Function, 
+							typename Reset>
+	void
+	bench_reps(std::size_t reps, 
+							Function& f, 
+							Reset& reset, 
+							Bench_meter& meter)
+	{
+		for (std::size_t i = 0; i != reps; ++i)
+		{
+			reset();
+			meter.start();
+			f();
+			meter.stop();
+		}
+	}
+	// Runs f for about 2^22 touched elements, work per run, after one
+	// warm up run unless a single run already covers that.
+	template <typename Function, 
+							typename Reset = Bench_no_reset>
+	Bench_row
+	bench_run(const char* container, 
+						const char* type, 
+						std::size_t size, 
+						const char* op, 
+						std::size_t ops, 
+						std::size_t work, 
+						Function f, 
+						Reset reset = Reset())
+	{
+		const std::size_t budget = std::size_t(1) << 22;
+		const std::size_t reps = (work < budget ? budget / work : 1);
+		if (reps > 1)
+		{
+			reset();
+			f();
+		}
+		Bench_meter meter;
+		bench_reps(reps, f, reset, meter);
+		return Bench_row{container, type, size, op, ops, 
+										meter.ns() / double(reps * ops), 
+										double(meter.bytes()) / double(reps),
+										double(meter.allocations()) / double(reps)};
+	}
+	// Rows as a table or as one JSON array
+	class
+	Bench_report
+	{
+		public:
+			explicit
+			Bench_report(bool json)
+				: M_json(json), M_rows(0)
+			{
+				if (M_json)
+				{
+					std::printf("[\n");
+				}
+				else
+				{
+					std::printf("%-12s %-7s %10s %-14s %12s %14s %10s\n", 
+											"container", "type", "size", "op", "ns/op", "bytes/run", "allocs/run");
+				}
+			}
+			~Bench_report()
+			{
+				if (M_json)
+				{
+					std::printf("\n]\n");
+				}
+			}
+			void
+			add(const Bench_row& r)
+			{
+				if (M_json)
+				{
+					std::printf("%s  {\"container\": \"%s\", \"type\": \"%s\", \"size\": %zu, "
+											"\"op\": \"%s\", \"ops_per_run\": %zu, \"ns_per_op\": %.4f, "
+											"\"bytes_per_run\": %.1f, \"allocations_per_run\": %.2f}",
+											(M_rows ? ",\n" : ""), r.container, r.type, r.size, 
+											r.op, r.ops, r.ns_per_op, r.bytes, r.allocations);
+				}
+				else
+				{
+					std::printf("%-12s %-7s %10zu %-14s %12.4f %14.1f %10.2f\n", 
+											r.container, r.type, r.size, r.op, r.ns_per_op, r.bytes, r.allocations);
+				}
+				std::fflush(stdout);
+				++M_rows;
+			}
+		private:
+			bool M_json;
+			std::size_t M_rows;
+	};
+	// Results are kept by storing them here
+	volatile std::size_t bench_sink = 0;
+
+	template <typename Vec>
+	void
+	bench_container(const char* container, 
+										std::size_t n, 
+										Bench_report& report)
+	{
+		typedef typename Vec::value_type Value_type;
+		typedef Bench_type<Value_type> Type;
+		Vec src;
+		src.reserve(n);
+		for (std::size_t i = 0; i != n; ++i)
+		{
+			src.push_back(Type::make(i));
+		}
+		report.add(bench_run(container, Type::name, n, "push_back", n, n,
+													[&]
+													{
+														Vec v;
+														for (std::size_t i = 0; i != n; ++i)
+														{
+															v.push_back(Type::make(i));
+														}
+														bench_sink = v.size();
+													}));
+		report.add(bench_run(container, Type::name, n, "emplace_back", n, n,
+													[&]
+													{
+														Vec v;
+														for (std::size_t i = 0; i != n; ++i)
+														{
+															Type::emplace_back(v, i);
+														}
+														bench_sink = v.size();
+													}));
+		{
+			// each insert or erase moves half of the elements
+			const std::size_t m = (std::size_t(1) << 20) / n;
+			const std::size_t k = (m > n ? n : (m ? m : 1));
+			Vec v(src);
+			auto 
+			reset = 
+			[&]
+			{
+				v = src;
+			};
+			report.add(bench_run(container, Type::name, n, "insert_middle", k, k * n,
+														[&]
+														{
+															for (std::size_t i = 0; i != k; ++i)
+															{
+																v.insert(v.begin() + std::ptrdiff_t(v.size() / 2), src[i]);
+															}
+															bench_sink = v.size();
+														}, reset));
+			report.add(bench_run(container, Type::name, n, "erase_middle", k, k * n,
+														[&]
+														{
+															for (std::size_t i = 0; i != k; ++i)
+															{
+																v.erase(v.begin() + std::ptrdiff_t(v.size() / 2));
+															}
+															bench_sink = v.size();
+														}, reset));
+		}
+		report.add(bench_run(container, Type::name, n, "reserve", 1, n,
+													[&]
+													{
+														Vec v;
+														v.reserve(n);
+														bench_sink = v.capacity();
+													}));
+		report.add(bench_run(container, Type::name, n, "resize", n, n,
+													[&]
+													{
+														Vec v;
+														v.resize(n);
+														bench_sink = v.size();
+													}));
+		report.add(bench_run(container, Type::name, n, "copy_assign", n, n,
+													[&]
+													{
+														Vec v;
+														v = src;
+														bench_sink = v.size();
+													}));
+		report.add(bench_run(container, Type::name, n, "move_assign", 2, 1,
+													[&]
+													{
+														Vec v;
+														v = std::move(src);
+														src = std::move(v);
+														bench_sink = src.size();
+													}));
+		report.add(bench_run(container, Type::name, n, "iterate", n, n,
+													[&]
+													{
+														std::size_t sum = 0;
+														for (const Value_type& x : src)
+														{
+															sum += Type::key(x);
+														}
+														bench_sink = sum;
+													}));
+		{
+			const Vec copy(src);
+			report.add(bench_run(container, Type::name, n, "equal", n, n,
+														[&]
+														{
+															bench_sink = (src == copy);
+														}));
+			report.add(bench_run(container, Type::name, n, "less", n, n,
+														[&]
+														{
+															bench_sink = (src < copy);
+														}));
+		}
+	}
+	// Skips sizes whose peak heap use passes max_bytes: the source,
+	// a copy and the container under test are live at once
+	template <typename T>
+	void
+	bench_type(std::size_t n, 
+							std::size_t max_bytes, 
+							Bench_report& report)
+	{
+		if (n > max_bytes / (3 * (sizeof(T) + Bench_type<T>::heap_bytes)))
+		{
+			return;
+		}
+		bench_container<vector<T>>("lib::Vector", n, report);
+		bench_container<std::vector<T>>("std::vector", n, report);
+	}
+	// Every operation on both containers for 16 to 100M elements,
+	// peak heap use at most LIB_BENCH_MAX_BYTES (512 MiB).
+	void
+	benchmark(bool json)
+	{
+		const char* env = std::getenv("LIB_BENCH_MAX_BYTES");
+		const std::size_t max_bytes = (env ? std::size_t(std::strtoull(env, 0, 10)) 
+																				: std::size_t(512) << 20);
+		static const std::size_t sizes[] = {16, 1024, 65536, 1048576, 100000000};
+		Bench_report report(json);
+		for (std::size_t n : sizes)
+		{
+			bench_type<int>(n, max_bytes, report);
+			bench_type<Bench_pod>(n, max_bytes, report);
+			bench_type<std::string>(n, max_bytes, report);
+		}
+	}
 	
 	void
 	use()
@@ -2680,6 +10103,138 @@ helper
 		print(v2.begin(),v2.end());				
 		std::cout << "v2 capacity: " << v2.capacity() << std::endl;
 		std::cout << "v2 size: " << v2.size() << std::endl;			
+		// request scoped arena, all memory released at the end of the scope
+		{
+			lib_impl::Arena arena;
+			lib::Vector<int, lib_impl::Arena_allocator<int>> v3{lib_impl::Arena_allocator<int>{arena}};
+			v3.assign(v2.begin(), v2.end());
+			v3.push_back(99);
+			print(v3.begin(),v3.end());
+			std::cout << "arena bytes used: " << arena.bytes_used() << std::endl;
+		}
+		// small Vectors from the thread local size class pool
+		// freed blocks are reused by the next Vector
+		for (int i = 0; i != 3; ++i)
+		{
+			lib::Vector<int, lib_impl::Pool_allocator<int>> v4(v2.begin(), v2.end());
+			v4.push_back(99);
+			print(v4.begin(),v4.end());
+		}
+		std::cout << "pool hit rate: " << lib_impl::Pool::stats().hit_rate() << std::endl;
+		// short Vectors kept inside the object, no allocation
+		{
+			lib::SmallVector<int, 16> v5(v2.begin(), v2.end());
+			v5.push_back(99);
+			print(v5.begin(),v5.end());
+			std::cout << "v5 inline: " << v5.is_inline() << std::endl;
+		}
+		// appends from several tasks, elements never move
+		{
+			lib::Concurrent_vector<int> v7;
+			const int& first = v7.push_back(-1);
+			auto 
+			append = 
+			[&v7]
+			{ 
+				for (int i = 0; i != 1000; ++i)
+				{
+					v7.push_back(i); 
+				}
+			};
+			std::future<void> t1 = lib_impl::async(append);
+			std::future<void> t2 = lib_impl::async(append);
+			lib_impl::wait(t1, t2);
+			std::cout << "v7 size: " << v7.size() << " first: " << first << std::endl;
+		}
+		// a failed segment allocation reserves no slot, later appends publish
+		{
+			lib::Concurrent_vector<int, Failing_allocator<int>> v13(4);
+			alloc_budget() = 1;
+			int failed = 0;
+			for (int i = 0; i != 8; ++i)
+			{
+				try
+				{
+					v13.push_back(i);
+				}
+				catch (const lib_impl::BadAlloc&)
+				{
+					++failed;
+					alloc_budget() = 1;
+				}
+			}
+			alloc_budget() = std::size_t(-1);
+			std::cout << "v13 size: " << v13.size() << " failed: " << failed << std::endl;
+		}
+		// binary image written and read back without per element work
+		if (std::FILE* tmp = std::tmpfile())
+		{
+			lib::write_binary(fileno(tmp), v2);
+			::lseek(fileno(tmp), 0, SEEK_SET);
+			vector<int> v9;
+			lib::read_binary(fileno(tmp), v9);
+			std::fclose(tmp);
+			print(v9.begin(),v9.end());
+		}
+		// Vector in a file, found again by the next run
+		if (const char* path = std::getenv("LIB_MAPPED_FILE"))
+		{
+			lib_impl::Mapped_file file(path);
+			auto v8 = lib::open_vector<int>(file);
+			v8.push_back(int(v8.size()));
+			lib::sync_vector(file, v8);
+			std::cout << "v8 size: " << v8.size() << std::endl;
+			// a Vector outside the file is never recorded as its root
+			lib::Vector<int, lib_impl::File_allocator<int>> outside(v8.begin(), v8.end());
+			try
+			{
+				lib::sync_vector(file, outside);
+			}
+			catch (const std::runtime_error& e)
+			{
+				std::cout << "outside: " << e.what() << std::endl;
+			}
+		}
+		// heap use of one Vector, reported under its own name
+		{
+			static lib_impl::Alloc_stats v10_stats("v10");
+			typedef lib_impl::Stats_allocator<lib_impl::Allocator<int>> Stats_alloc;
+			lib::Vector<int, Stats_alloc> v10{Stats_alloc(v10_stats)};
+			for (int i = 0; i != 1000; ++i)
+			{
+				v10.push_back(i);
+			}
+			const lib_impl::Alloc_stats* s = lib_impl::Alloc_registry::find("v10");
+			std::cout << "v10 peak bytes: " << s->peak_bytes() 
+								<< " growths: " << s->growths() << std::endl;
+		}
+		// over-aligned elements start on their alignment
+		{
+			struct alignas(64) Line : Bench_pod {};
+			vector<Line> v12(3, Line{});
+			v12.push_back(Line{});
+			std::cout << "v12 alignment: " << vector<Line>::alignment 
+								<< " aligned: " << (reinterpret_cast<std::uintptr_t>(&v12[0]) % 64 == 0) 
+								<< std::endl;
+		}
+		// large buffer on transparent huge pages, grown by remapping
+		{
+			lib::Vector<double, lib_impl::Huge_page_allocator<double>> v11;
+			v11.resize(1 << 18);
+			v11.resize(1 << 19);
+			std::cout << "v11 huge page bytes advised: " << lib_impl::Huge_pages::advised_bytes() 
+								<< " aligned: " << (reinterpret_cast<std::uintptr_t>(&v11[0]) 
+																			% lib_impl::Huge_pages::page_size == 0) << std::endl;
+		}
+		// chunks of a large Vector on the thread pool
+		{
+			vector<double> v6(1 << 20, lib::default_init, lib_impl::Allocator<double>());
+			lib::for_each(lib::par, v6.begin(), v6.end(), [](double& x){ x = 0.5; });
+			lib::inclusive_scan(lib::par, v6.begin(), v6.end(), v6.begin());
+			// same sum for any number of threads
+			const double sum = lib::reduce(lib::par.deterministic(), v6.begin(), v6.end(), 0.0);
+			std::cout << "v6 back: " << v6.back() << " sum: " << sum << std::endl;
+		}
 		throw std::runtime_error("Vector::use() error");
 	}
 }
@@ -2689,14 +10244,21 @@ int
 main(int argc,
 		char* argv[])
 {
+  if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+  {
+  	helper::benchmark(argc > 2 && std::strcmp(argv[2], "--json") == 0);
+  	return 0;
+  }
+	helper::start_alloc_trace();
 	// Asynchronous task-based concurrency
 	// store exception thrown 
   std::promise<int> prom;
   std::future<int> fut = prom.get_future();
 
-	// thread-based concurrency
-  std::thread 
-  t(
+	// task-based concurrency on a pinned worker of the thread pool
+  std::future<void> 
+  task = 
+  lib_impl::async(
   	[&prom]
 		{
 		  try 
@@ -2725,7 +10287,7 @@ main(int argc,
 
   try 
   {
-  	// throws stored exception from thread
+  	// throws stored exception from the task
     std::cout << fut.get();
   } 
   catch(const std::exception& err) 
@@ -2736,6 +10298,8 @@ main(int argc,
 	catch (...) 
 	{	
 	}
-	t.join();
+	lib_impl::wait(task);
+	helper::stop_alloc_trace();
+	helper::dump_alloc_stats();
 	return 0;
 }
\ No newline at end of file